@@ -0,0 +1,81 @@
+#ifndef GENTREE_BENCHMARKS_BENCH_UTILS_H_
+#define GENTREE_BENCHMARKS_BENCH_UTILS_H_
+
+#include "memory_usage.h"
+#include "rand_bracket_seq.h"
+#include "rand_utils.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+// Every benchmark draws its input from this seed, so runs are comparable
+constexpr std::uint64_t kBenchSeed = 20240601ull;
+
+constexpr std::int64_t kMinNodes = 1'000;
+constexpr std::int64_t kMaxNodes = 100'000'000;
+
+// Swallows whatever is written to it, counting the bytes
+class CountingBuffer : public std::streambuf {
+  std::int64_t bytes_ = 0;
+ protected:
+  int_type overflow(int_type ch) override {
+    ++bytes_;
+    return traits_type::not_eof(ch);
+  }
+  std::streamsize xsputn(const char *, std::streamsize count) override {
+    bytes_ += count;
+    return count;
+  }
+ public:
+  [[nodiscard]] std::int64_t bytes() const { return bytes_; }
+};
+
+/**
+ * Attributes memory to the stage measured between construction and report():
+ * heap growth per node (from the allocation hooks) and the peak RSS.
+ */
+class MemoryProbe {
+  std::int64_t base_live_;
+ public:
+  MemoryProbe() {
+    MemoryUsage::reset_peak_rss();
+    MemoryUsage::track_allocations(true);
+    MemoryUsage::reset_peak_live();
+    base_live_ = MemoryUsage::allocations().live_bytes;
+  }
+  void report(benchmark::State &state, std::int64_t n) {
+    const auto snapshot = MemoryUsage::allocations();
+    MemoryUsage::track_allocations(false);
+    state.SetItemsProcessed(state.iterations() * n);
+    state.counters["nodes/s"] =
+        benchmark::Counter(static_cast<double>(n), benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["bytes/node"] =
+        static_cast<double>(snapshot.peak_live_bytes - base_live_) / static_cast<double>(n);
+    state.counters["peak_rss_MiB"] =
+        static_cast<double>(MemoryUsage::peak_rss_bytes()) / (1 << 20);
+  }
+};
+
+// A uniformly random word of n '(' and n ')', i.e. the input of the phi bijection
+inline std::string random_word(size_t n, std::uint64_t seed= kBenchSeed) {
+  rand_utils utils(seed);
+  const auto L = utils.rand_subset(2*n, n);
+  std::string x(2*n, ')');
+  for (auto pos : L)
+    x[pos]= '(';
+  return x;
+}
+
+// The balanced parentheses sequence of a random n-node ordinal tree
+inline std::string random_tree_bps(size_t n, std::uint64_t seed= kBenchSeed) {
+  std::ostringstream os;
+  RandomBrackSeqImpl(n, seed).generate(os);
+  return os.str();
+}
+
+#endif //GENTREE_BENCHMARKS_BENCH_UTILS_H_
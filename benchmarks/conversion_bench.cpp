@@ -0,0 +1,93 @@
+//
+// Output stages of otree: proto conversion, weights and the text edge list
+//
+#include "bench_utils.h"
+
+#include "async_writer.h"
+#include "ordinal_tree.pb.h"
+#include "ordinal_tree_io.h"
+#include "rand_bracket_seq.h"
+#include "rand_utils.h"
+
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+  void BM_Convert(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto s = random_tree_bps(n);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      random_ordinal_tree::ordinal_tree tree;
+      convert(s, tree);
+      benchmark::DoNotOptimize(tree);
+    }
+    probe.report(state, n);
+  }
+
+  void BM_RandWeights(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    MemoryProbe probe;
+    for (auto _ : state) {
+      auto weights = rand_utils::rand_weights(n, 1, 1'000'000, kBenchSeed);
+      benchmark::DoNotOptimize(weights.data());
+    }
+    probe.report(state, n);
+  }
+
+  // range(1) != 0 prints a line of weights before the edges
+  void BM_Print(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    random_ordinal_tree::ordinal_tree tree;
+    convert(random_tree_bps(n), tree);
+    std::optional<std::vector<std::int64_t>> weights;
+    if (state.range(1)) {
+      weights = rand_utils::rand_weights(n, 1, 1'000'000, kBenchSeed);
+    }
+    CountingBuffer buf;
+    std::ostream os(&buf);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      print(os, tree, weights, 0);
+    }
+    state.SetBytesProcessed(buf.bytes());
+    probe.report(state, n);
+  }
+
+  // The text edge list written to a temporary file, through std::ofstream (range(1) = 0)
+  // or AsyncOstream (range(1) = 1), so that printing and writing overlap
+  void BM_PrintToFile(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    random_ordinal_tree::ordinal_tree tree;
+    convert(random_tree_bps(n), tree);
+    const auto path = "/tmp/gentree_bench_" + std::to_string(n) + ".txt";
+    for (auto _ : state) {
+      if (state.range(1)) {
+        AsyncOstream os(path);
+        print<std::vector<std::int64_t>>(os, tree, std::nullopt, 0);
+        os.close();
+      } else {
+        std::ofstream os(path, std::ios::binary);
+        print<std::vector<std::int64_t>>(os, tree, std::nullopt, 0);
+      }
+    }
+    std::remove(path.c_str());
+  }
+
+} // namespace
+
+BENCHMARK(BM_Convert)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RandWeights)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Print)
+    ->ArgNames({"n", "weights"})
+    ->ArgsProduct({benchmark::CreateRange(kMinNodes, kMaxNodes, 10), {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PrintToFile)
+    ->ArgNames({"n", "async"})
+    ->ArgsProduct({benchmark::CreateRange(kMinNodes * 100, kMaxNodes / 10, 10), {0, 1}})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,80 @@
+//
+// Tree covering: parsing the edge list, building the covering (with calcCard) and decompose+print
+//
+#include "bench_utils.h"
+
+#include "ordinal_tree.pb.h"
+#include "ordinal_tree_io.h"
+#include "tree_covering.h"
+#include "tree_loader.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+  // decompose() is superlinear in practice; larger trees take minutes per iteration
+  constexpr std::int64_t kMaxCoveringNodes = 10'000'000;
+
+  std::string random_edge_list(size_t n) {
+    random_ordinal_tree::ordinal_tree tree;
+    convert(random_tree_bps(n), tree);
+    std::ostringstream os;
+    print<std::vector<std::int64_t>>(os, tree, std::nullopt, 1);
+    return os.str();
+  }
+
+  // range(1) is the number of parser threads
+  void BM_LoadTree(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto input = random_edge_list(n);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      auto tree = load_tree(input.data(), input.size(), static_cast<unsigned>(state.range(1)));
+      benchmark::DoNotOptimize(tree.edges.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(input.size()));
+    probe.report(state, n);
+  }
+
+  void BM_TreeCoveringBuild(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto input = random_edge_list(n);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      std::istringstream is(input);
+      auto covering = createTreeCovering(is);
+      benchmark::DoNotOptimize(covering.get());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(input.size()));
+    probe.report(state, n);
+  }
+
+  void BM_TreeCoveringPrint(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto L = static_cast<size_t>(state.range(1));
+    std::istringstream is(random_edge_list(n));
+    auto covering = createTreeCovering(is);
+    CountingBuffer buf;
+    std::ostream os(&buf);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      covering->print(os, L);
+    }
+    state.SetBytesProcessed(buf.bytes());
+    probe.report(state, n);
+  }
+
+} // namespace
+
+BENCHMARK(BM_LoadTree)
+    ->ArgNames({"n", "threads"})
+    ->ArgsProduct({benchmark::CreateRange(kMinNodes, kMaxNodes, 10), {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TreeCoveringBuild)
+    ->RangeMultiplier(10)->Range(kMinNodes, kMaxCoveringNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TreeCoveringPrint)
+    ->ArgNames({"n", "L"})
+    ->ArgsProduct({benchmark::CreateRange(kMinNodes, kMaxCoveringNodes, 10), {4, 16, 64, 256}})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,185 @@
+//
+// Generation stages: subset sampling, the phi bijection, and the Graph built
+// from the resulting balanced sequence
+//
+#include "bench_utils.h"
+
+#include "Graph.h"
+#include "boltzmann_ordinal_tree.h"
+#include "prufer_tree.h"
+#include "rand_bracket_seq.h"
+#include "rand_ordinal_tree_from_bps.h"
+#include "tree_enumerator.h"
+#include "rand_utils.h"
+
+#include <sstream>
+#include <string>
+
+namespace {
+
+  void BM_RandSubset(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    rand_utils utils(kBenchSeed);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      auto L = utils.rand_subset(2*n, n);
+      benchmark::DoNotOptimize(L.data());
+    }
+    probe.report(state, n);
+  }
+
+  void BM_ExplicitStackPhi(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto w = random_word(n - 1);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      auto s = RandomBrackSeqImpl::explicit_stack_phi(w);
+      benchmark::DoNotOptimize(s.data());
+    }
+    probe.report(state, n);
+  }
+
+  void BM_RandomBrackSeq(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    RandomBrackSeqImpl seq(n, kBenchSeed);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      std::ostringstream os;
+      seq.generate(os);
+      benchmark::DoNotOptimize(os);
+    }
+    probe.report(state, n);
+  }
+
+  // the same sequences pushed straight into packed bits and into a parent array
+  void BM_RandomBrackSeqToBits(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    RandomBrackSeqImpl seq(n, kBenchSeed);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      BpBitSink sink(n);
+      seq.generate_to(sink);
+      benchmark::DoNotOptimize(sink.words().data());
+    }
+    probe.report(state, n);
+  }
+
+  void BM_RandomBrackSeqToParents(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    RandomBrackSeqImpl seq(n, kBenchSeed);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      ParentArraySink sink(n);
+      seq.generate_to(sink);
+      benchmark::DoNotOptimize(sink.parents().data());
+    }
+    probe.report(state, n);
+  }
+
+  void BM_GraphInit(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto s = random_tree_bps(n);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      Graph g(s);
+      benchmark::DoNotOptimize(g.size());
+    }
+    probe.report(state, n);
+  }
+
+  void BM_GraphSerialize(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const Graph g(random_tree_bps(n));
+    CountingBuffer buf;
+    std::ostream os(&buf);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      g.serialize(os);
+    }
+    state.SetBytesProcessed(buf.bytes());
+    probe.report(state, n);
+  }
+
+  void BM_RandOrdinalTree(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    MemoryProbe probe;
+    for (auto _ : state) {
+      RandOrdinalTreeFromBinary tree(n, kBenchSeed);
+      benchmark::DoNotOptimize(tree);
+    }
+    probe.report(state, n);
+  }
+
+  // Unary-binary trees; range(1) is the size tolerance in percent (0: exact size)
+  void BM_BoltzmannOrdinalTree(benchmark::State &state) {
+    BoltzmannParams params;
+    params.degree_weights = {1, 1, 1};
+    params.n = static_cast<size_t>(state.range(0));
+    params.tolerance = static_cast<double>(state.range(1)) / 100;
+    std::uint64_t seed = kBenchSeed;
+    MemoryProbe probe;
+    for (auto _ : state) {
+      BoltzmannOrdinalTree tree(params, seed++);
+      benchmark::DoNotOptimize(tree.size());
+    }
+    probe.report(state, params.n);
+  }
+
+  void BM_PruferDecode(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto code = random_prufer_sequence(n, kBenchSeed);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      auto parents = prufer_parents(code);
+      benchmark::DoNotOptimize(parents.data());
+    }
+    probe.report(state, n);
+  }
+
+  // range(1) threads draw the sequence and count degrees
+  void BM_RandomFreeTree(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto threads = static_cast<unsigned>(state.range(1));
+    std::uint64_t seed = kBenchSeed;
+    MemoryProbe probe;
+    for (auto _ : state) {
+      auto parents = random_free_tree(n, seed++, threads);
+      benchmark::DoNotOptimize(parents.data());
+    }
+    probe.report(state, n);
+  }
+
+  // every tree with range(0) nodes; items are trees
+  void BM_EnumerateTrees(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    std::int64_t trees = 0;
+    for (auto _ : state) {
+      OrdinalTreeEnumerator e(n);
+      do {
+        benchmark::DoNotOptimize(e.bps().data());
+      } while (e.next());
+      trees += static_cast<std::int64_t>(e.rank());
+    }
+    state.SetItemsProcessed(trees);
+  }
+
+} // namespace
+
+BENCHMARK(BM_RandSubset)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExplicitStackPhi)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RandomBrackSeq)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RandomBrackSeqToBits)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RandomBrackSeqToParents)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GraphInit)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GraphSerialize)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RandOrdinalTree)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BoltzmannOrdinalTree)
+    ->ArgNames({"n", "tolerance_pct"})
+    ->ArgsProduct({benchmark::CreateRange(kMinNodes, kMaxNodes, 10), {0, 5}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PruferDecode)->RangeMultiplier(10)->Range(kMinNodes, kMaxNodes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_RandomFreeTree)
+    ->ArgNames({"n", "threads"})
+    ->ArgsProduct({benchmark::CreateRange(kMinNodes, kMaxNodes, 10), {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EnumerateTrees)->DenseRange(8, 16, 4)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,67 @@
+//
+// Tree queries: building the reference oracle and answering LCA/level-ancestor workloads
+//
+#include "bench_utils.h"
+
+#include "query_workload.h"
+#include "tree_oracle.h"
+
+#include <vector>
+
+namespace {
+
+  // (parent, child) edges of a random tree, in preorder ids
+  std::vector<tree_edge> random_tree_edges(size_t n) {
+    std::vector<tree_edge> edges;
+    std::vector<std::uint32_t> stack;
+    std::uint32_t next = 0;
+    for (auto ch : random_tree_bps(n)) {
+      if (ch == '(') {
+        if (not stack.empty()) {
+          edges.emplace_back(stack.back(), next);
+        }
+        stack.push_back(next++);
+      } else {
+        stack.pop_back();
+      }
+    }
+    return edges;
+  }
+
+  // range(1) is the number of threads
+  void BM_TreeOracleBuild(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto threads = static_cast<unsigned>(state.range(1));
+    const auto edges = random_tree_edges(n);
+    MemoryProbe probe;
+    for (auto _ : state) {
+      TreeOracle oracle(n, edges, {}, threads);
+      benchmark::DoNotOptimize(oracle.root());
+    }
+    probe.report(state, n);
+  }
+
+  // range(1) is the QueryKind, range(2) the number of threads
+  void BM_AnswerQueries(benchmark::State &state) {
+    constexpr std::uint64_t kQueries = 1'000'000;
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto threads = static_cast<unsigned>(state.range(2));
+    const TreeOracle oracle(n, random_tree_edges(n), {}, threads);
+    auto queries = make_queries(oracle, {static_cast<QueryKind>(state.range(1))}, kQueries, kBenchSeed, threads);
+    for (auto _ : state) {
+      answer_queries(oracle, queries, threads);
+      benchmark::DoNotOptimize(queries.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kQueries));
+  }
+
+} // namespace
+
+BENCHMARK(BM_TreeOracleBuild)
+    ->ArgNames({"n", "threads"})
+    ->ArgsProduct({benchmark::CreateRange(kMinNodes, kMaxNodes / 10, 10), {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_AnswerQueries)
+    ->ArgNames({"n", "kind", "threads"})
+    ->ArgsProduct({benchmark::CreateRange(kMinNodes, kMaxNodes / 10, 10), {0, 1, 2, 3}, {1, 4}})
+    ->Unit(benchmark::kMillisecond);
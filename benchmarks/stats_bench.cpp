@@ -0,0 +1,60 @@
+//
+// Tree statistics: validating and measuring a parentheses sequence in one pass
+//
+#include "bench_utils.h"
+
+#include "tree_stats.h"
+
+#include <string>
+
+namespace {
+
+  // range(1) is the number of threads
+  void BM_TreeStatsBP(benchmark::State &state) {
+    const auto n = static_cast<size_t>(state.range(0));
+    const auto threads = static_cast<unsigned>(state.range(1));
+    const auto bps = random_tree_bps(n);
+    for (auto _ : state) {
+      const auto stats = tree_stats(bps.data(), bps.size(), threads);
+      benchmark::DoNotOptimize(stats.height);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(bps.size()));
+  }
+
+  // range(0) is the number of threads. Each slice is 2^20+62 bytes, so its last 62 are scanned byte
+  // by byte, and slices 1, 3, ..., which start two deep, end in a run of 126 opens closed in the next
+  // slice. Checks that the slices' statistics match those of a single scan.
+  void BM_TreeStatsDeepCut(benchmark::State &state) {
+    const auto threads = static_cast<unsigned>(state.range(0));
+    constexpr size_t kSlice = (1 << 20) + 62, kRun = 126;
+    std::string bps = "((";
+    for (unsigned t = 1; t <= threads; ++t) {
+      const bool run = t < threads and t % 2 == 0;
+      const auto end = t * kSlice - (run ? kRun : t < threads ? 0 : 2);
+      while (bps.size() < end) {
+        bps += "()";
+      }
+      if (run) {
+        bps += std::string(kRun, '(') + std::string(kRun, ')');
+      }
+    }
+    bps += "))";
+    const auto expected = tree_stats(bps.data(), bps.size(), 1);
+    for (auto _ : state) {
+      const auto stats = tree_stats(bps.data(), bps.size(), threads);
+      if (stats.n != expected.n or stats.height != expected.height or stats.depths != expected.depths) {
+        state.SkipWithError("the slices disagree with a single scan");
+        break ;
+      }
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(bps.size()));
+  }
+
+} // namespace
+
+BENCHMARK(BM_TreeStatsBP)
+    ->ArgNames({"n", "threads"})
+    ->ArgsProduct({benchmark::CreateRange(kMinNodes, kMaxNodes, 10), {1, 4}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TreeStatsDeepCut)->ArgName("threads")->DenseRange(3, 5)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,124 @@
+#ifndef GENTREE_BRACKET_SEQUENCES_BP_SINK_H_
+#define GENTREE_BRACKET_SEQUENCES_BP_SINK_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Where the generators' generate_to(sink) push a balanced parentheses sequence. A sink is any
+ * type with
+ *   void open();   // '(' -- a node starts, in preorder
+ *   void close();  // ')' -- its subtree ends
+ * called once per parenthesis, in order. Generators take the sink as a template parameter, so the
+ * calls are resolved at compile time and inlined into their loops; the ostream generate()
+ * overloads are TextSinks around generate_to().
+ */
+
+// The characters, through a small buffer, to an ostream
+class TextSink {
+  static constexpr size_t kCapacity = 1 << 12;
+  std::ostream &os_;
+  char buf_[kCapacity];
+  size_t len_ = 0;
+  void put(char ch) {
+    if (len_ == kCapacity) {
+      flush();
+    }
+    buf_[len_++] = ch;
+  }
+ public:
+  explicit TextSink(std::ostream &os) : os_(os) {}
+  ~TextSink() { flush(); }
+  TextSink(const TextSink&) = delete;
+  TextSink& operator=(const TextSink&) = delete;
+  void open() { put('('); }
+  void close() { put(')'); }
+  void flush() {
+    os_.write(buf_, static_cast<std::streamsize>(len_));
+    len_ = 0;
+  }
+};
+
+// The characters, appended to a string
+class StringSink {
+  std::string &s_;
+ public:
+  explicit StringSink(std::string &s) : s_(s) {}
+  void open() { s_.push_back('('); }
+  void close() { s_.push_back(')'); }
+};
+
+// The sequence packed 64 parentheses to a word: bit i%64 of word i/64 is set when parenthesis i opens
+class BpBitSink {
+  std::vector<std::uint64_t> words_;
+  std::uint64_t size_ = 0;
+  void push(std::uint64_t bit) {
+    if ((size_ & 63) == 0) {
+      words_.push_back(0);
+    }
+    words_.back() |= bit << (size_ & 63);
+    ++size_;
+  }
+ public:
+  BpBitSink() = default;
+  // room for the 2n parentheses of an n-node tree
+  explicit BpBitSink(std::uint64_t n) { words_.reserve((2 * n + 63) / 64); }
+  void open() { push(1); }
+  void close() { push(0); }
+  [[nodiscard]] std::uint64_t size() const { return size_; }
+  [[nodiscard]] const std::vector<std::uint64_t> &words() const { return words_; }
+  // Pushes the stored sequence to another sink
+  template<typename Sink>
+  void replay(Sink &sink) const {
+    for (std::uint64_t i = 0; i < size_; i += 64) {
+      auto w = words_[i / 64];
+      const auto end = std::min<std::uint64_t>(64, size_ - i);
+      for (std::uint64_t k = 0; k < end; ++k, w >>= 1) {
+        if (w & 1) {
+          sink.open();
+        } else {
+          sink.close();
+        }
+      }
+    }
+  }
+};
+
+// The parent of every node, nodes being numbered in preorder; the root, 0, is its own parent
+class ParentArraySink {
+  std::vector<std::uint32_t> parents_, path_;
+ public:
+  ParentArraySink() = default;
+  explicit ParentArraySink(std::uint64_t n) { parents_.reserve(n); }
+  void open() {
+    const auto v = static_cast<std::uint32_t>(parents_.size());
+    parents_.push_back(path_.empty() ? 0 : path_.back());
+    path_.push_back(v);
+  }
+  void close() { path_.pop_back(); }
+  [[nodiscard]] const std::vector<std::uint32_t> &parents() const { return parents_; }
+  std::vector<std::uint32_t> release() { return std::move(parents_); }
+};
+
+// Calls fn(parent, child) for every edge, in preorder of the children
+template<typename Fn>
+class EdgeSink {
+  Fn fn_;
+  std::vector<std::uint64_t> path_;
+  std::uint64_t next_ = 0;
+ public:
+  explicit EdgeSink(Fn fn) : fn_(std::move(fn)) {}
+  void open() {
+    if (not path_.empty()) {
+      fn_(path_.back(), next_);
+    }
+    path_.push_back(next_++);
+  }
+  void close() { path_.pop_back(); }
+};
+
+#endif //GENTREE_BRACKET_SEQUENCES_BP_SINK_H_
@@ -0,0 +1,109 @@
+#include "bracket_seq_ranker.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+BrackSeqRanker::BrackSeqRanker(size_t n) : n_(n) {
+  if (n > kMaxPairs) {
+    throw std::invalid_argument("cannot rank sequences of more than " + std::to_string(kMaxPairs) + " pairs");
+  }
+  // filled backwards from the end of the sequence: a full prefix completes only at excess 0.
+  // Only reachable states (e <= i) are filled, so every entry is at most Catalan(n).
+  ballot_.assign((2 * n + 1) * (n + 1), 0);
+  ballot_[2 * n * (n + 1)] = 1;
+  for (auto i = 2 * n; i-- > 0;) {
+    for (size_t e = 0; e <= std::min(i, 2 * n - i); ++e) {
+      rank_type c = completions(i + 1, e + 1);
+      if (e > 0) {
+        c += completions(i + 1, e - 1);
+      }
+      ballot_[i * (n + 1) + e] = c;
+    }
+  }
+}
+
+BrackSeqRanker::rank_type BrackSeqRanker::rank(const std::string &s) const {
+  assert(s.size() == 2 * n_);
+  rank_type k = 0;
+  size_t e = 0;
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '(') {
+      ++e;
+    } else {
+      // every sequence that opens here comes first
+      k += completions(i + 1, e + 1);
+      --e;
+    }
+  }
+  assert(e == 0);
+  return k;
+}
+
+void BrackSeqRanker::unrank(rank_type k, std::string &out) const {
+  if (k >= count()) {
+    throw std::out_of_range("rank " + to_string(k) + " is not below " + to_string(count()));
+  }
+  out.resize(2 * n_);
+  size_t e = 0;
+  for (size_t i = 0; i < out.size(); ++i) {
+    const auto opening = completions(i + 1, e + 1);
+    if (k < opening) {
+      out[i] = '(';
+      ++e;
+    } else {
+      k -= opening;
+      out[i] = ')';
+      --e;
+    }
+  }
+}
+
+std::string BrackSeqRanker::unrank(rank_type k) const {
+  std::string out;
+  unrank(k, out);
+  return out;
+}
+
+BrackSeqRanker::rank_type BrackSeqRanker::random_rank(std::mt19937_64 &rng) const {
+  const auto c = count();
+  unsigned bits = 0;
+  while (bits < 128 and (c - 1) >> bits) {
+    ++bits;
+  }
+  const auto mask = bits == 128 ? ~rank_type{0} : (rank_type{1} << bits) - 1;
+  for (;;) {
+    const auto k = ((static_cast<rank_type>(rng()) << 64) | rng()) & mask;
+    if (k < c) {
+      return k;
+    }
+  }
+}
+
+std::optional<BrackSeqRanker::rank_type> BrackSeqRanker::parse_rank(const std::string &s) {
+  if (s.empty()) {
+    return std::nullopt;
+  }
+  rank_type k = 0;
+  for (auto ch : s) {
+    if (ch < '0' or ch > '9') {
+      return std::nullopt;
+    }
+    const auto digit = static_cast<rank_type>(ch - '0');
+    if (k > (~rank_type{0} - digit) / 10) {
+      return std::nullopt;
+    }
+    k = k * 10 + digit;
+  }
+  return k;
+}
+
+std::string BrackSeqRanker::to_string(rank_type k) {
+  std::string s;
+  do {
+    s.push_back(static_cast<char>('0' + static_cast<int>(k % 10)));
+    k /= 10;
+  } while (k > 0);
+  std::reverse(s.begin(), s.end());
+  return s;
+}
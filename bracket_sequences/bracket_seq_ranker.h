@@ -0,0 +1,48 @@
+#ifndef GENTREE_BRACKET_SEQUENCES_BRACKET_SEQ_RANKER_H_
+#define GENTREE_BRACKET_SEQUENCES_BRACKET_SEQ_RANKER_H_
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Ranks the balanced sequences of n pairs in lexicographic order, '(' first,
+ * onto [0, Catalan(n)): rank 0 is (^n )^n. Both directions are O(n) walks over a
+ * table of ballot numbers, kept in 128 bits; sizes whose count does not fit
+ * (n > kMaxPairs) are rejected.
+ */
+class BrackSeqRanker {
+ public:
+  using rank_type = unsigned __int128;
+  static constexpr size_t kMaxPairs = 69;
+
+  // throws std::invalid_argument for n > kMaxPairs
+  explicit BrackSeqRanker(size_t n);
+
+  [[nodiscard]] size_t pairs() const { return n_; }
+  // Catalan(n)
+  [[nodiscard]] rank_type count() const { return completions(0, 0); }
+  // "s" must be balanced with n pairs
+  [[nodiscard]] rank_type rank(const std::string &s) const;
+  // writes the sequence of rank k < count() into "out", reusing its storage
+  void unrank(rank_type k, std::string &out) const;
+  [[nodiscard]] std::string unrank(rank_type k) const;
+  // exactly uniform over [0, count()), by rejection from the next power of two
+  rank_type random_rank(std::mt19937_64 &rng) const;
+
+  static std::optional<rank_type> parse_rank(const std::string &s);
+  static std::string to_string(rank_type k);
+
+ private:
+  // balanced completions of a prefix of length i with excess e
+  [[nodiscard]] rank_type completions(size_t i, size_t e) const {
+    return e <= n_ ? ballot_[i * (n_ + 1) + e] : 0;
+  }
+
+  size_t n_;
+  std::vector<rank_type> ballot_;
+};
+
+#endif //GENTREE_BRACKET_SEQUENCES_BRACKET_SEQ_RANKER_H_
@@ -0,0 +1,129 @@
+#include "external_bracket_seq.h"
+
+#include "phase_stats.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+  // SplitMix64: a generator whose whole state is one word, so every block can have its own,
+  // seeded from (seed, block index), and a checkpoint needs no generator state at all
+  class BlockEngine {
+    std::uint64_t state_;
+   public:
+    BlockEngine(std::uint64_t seed, std::uint64_t block)
+        : state_(seed ^ (block + 1) * 0xd1b54a32d192ed03ull) {}
+    std::uint64_t operator()() {
+      auto z = (state_ += 0x9e3779b97f4a7c15ull);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+      return z ^ (z >> 31);
+    }
+  };
+
+  // Selection sampling (Knuth's Algorithm S) of the word's n-1 '(' among its 2n-1
+  // positions; "visit" sees every position in order
+  template<typename Visit>
+  void sample(BlockEngine &engine, std::uint64_t t, std::uint64_t t_end,
+              std::uint64_t opened, std::uint64_t opens, std::uint64_t positions, Visit &&visit) {
+    for (; t < t_end; ++t) {
+      const auto left = positions - t;
+      // uniform in [0, left) without a division
+      const auto r = static_cast<std::uint64_t>((static_cast<unsigned __int128>(engine()) * left) >> 64);
+      const bool open = r < opens - opened;
+      opened += open;
+      visit(t, open);
+    }
+  }
+
+} // namespace
+
+ExternalBrackSeq::ExternalBrackSeq(std::uint64_t n, size_t memory_budget, std::uint64_t seed)
+    : n_(n), seed_(seed) {
+  assert(n >= 1);
+  // Half of the budget goes to the block being emitted, at most a quarter to the
+  // checkpoints (the '(' count at every block start)
+  const auto positions = 2*n - 1;
+  block_size_ = std::max<std::uint64_t>(1, memory_budget / 2);
+  const auto checkpoint_bytes = (positions / block_size_ + 1) * sizeof(std::uint64_t);
+  if (memory_budget < kMinBlockSize * 2 or checkpoint_bytes > memory_budget / 4) {
+    // the budget must be at least about sqrt(128n) bytes
+    throw std::invalid_argument("a memory budget of " + std::to_string(memory_budget) + " bytes is too small for "
+                                + std::to_string(n) + " nodes");
+  }
+}
+
+// The word has one more ')' than '(', so its prefix sums end at -1; the rotation
+// starting right after the first position where they are lowest is the only one
+// that is balanced up to its final ')'
+void ExternalBrackSeq::locate_rotation() {
+  ScopedPhase phase("prefix_min");
+  const auto positions = 2*n_ - 1, opens = n_ - 1;
+  opened_.clear();
+  std::int64_t level = 0, lowest = std::numeric_limits<std::int64_t>::max();
+  std::uint64_t opened = 0;
+  for (std::uint64_t start = 0; start < positions; start += block_size_) {
+    opened_.push_back(opened);
+    BlockEngine engine(seed_, start / block_size_);
+    const auto end = std::min(positions, start + block_size_);
+    // per block: its total and the first position of its own lowest prefix
+    std::int64_t sum = 0, block_lowest = std::numeric_limits<std::int64_t>::max();
+    std::uint64_t block_argmin = start;
+    sample(engine, start, end, opened, opens, positions, [&](std::uint64_t t, bool open) {
+      opened += open;
+      if ((sum += open ? 1 : -1) < block_lowest) {
+        block_lowest = sum, block_argmin = t;
+      }
+    });
+    if (level + block_lowest < lowest) {
+      lowest = level + block_lowest, rotation_ = block_argmin + 1;
+    }
+    level += sum;
+  }
+  assert(level == -1 and opened == opens);
+  rotation_ %= positions;
+}
+
+void ExternalBrackSeq::emit(std::uint64_t from, std::uint64_t to, std::vector<char> &buf,
+                            const sink_type &sink) const {
+  const auto positions = 2*n_ - 1, opens = n_ - 1;
+  for (auto b = from / block_size_; from < to; ++b) {
+    BlockEngine engine(seed_, b);
+    const auto start = b * block_size_, end = std::min(positions, start + block_size_);
+    const auto stop = std::min(end, to);
+    size_t len = 0;
+    sample(engine, start, stop, opened_[b], opens, positions, [&](std::uint64_t t, bool open) {
+      if (t >= from) {
+        buf[len++] = open ? '(' : ')';
+      }
+    });
+    sink(buf.data(), len);
+    from = stop;
+  }
+}
+
+void ExternalBrackSeq::generate(const sink_type &sink) {
+  locate_rotation();
+  ScopedPhase phase("emit");
+  const auto positions = 2*n_ - 1;
+  std::vector<char> buf(std::min(block_size_, positions));
+  // the rotated word, minus its final ')', wrapped in the root's pair
+  sink("(", 1);
+  if (rotation_ == 0) {
+    emit(0, positions - 1, buf, sink);
+  } else {
+    emit(rotation_, positions, buf, sink);
+    emit(0, rotation_ - 1, buf, sink);
+  }
+  sink(")", 1);
+}
+
+void ExternalBrackSeq::generate(std::ostream &os) {
+  generate([&os](const char *data, size_t len) {
+    os.write(data, static_cast<std::streamsize>(len));
+  });
+}
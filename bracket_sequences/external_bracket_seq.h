@@ -0,0 +1,43 @@
+#ifndef GENTREE_BRACKET_SEQUENCES_EXTERNAL_BRACKET_SEQ_H_
+#define GENTREE_BRACKET_SEQUENCES_EXTERNAL_BRACKET_SEQ_H_
+
+#include "rand_bracket_seq_iface.h"
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+/**
+ * The balanced parentheses sequence of a uniformly random ordinal tree with n
+ * nodes, produced piecewise for trees that do not fit in memory.
+ * A word of n-1 '(' and n ')' is sampled position by position; a first pass
+ * keeps only per-block prefix sums and minima (and the '(' count at every block start;
+ * each block draws from its own generator, seeded by the block index) to locate the
+ * cycle-lemma rotation, a second one regenerates the blocks in rotated order.
+ * RAM stays within "memory_budget" bytes; a budget below about sqrt(128n) bytes, which
+ * cannot hold both a block and the checkpoints, throws std::invalid_argument.
+ */
+class ExternalBrackSeq : public IRandomBrackSeq {
+ public:
+  using sink_type = std::function<void(const char *data, size_t len)>;
+ private:
+  // no block is smaller than this many positions
+  static constexpr std::uint64_t kMinBlockSize = 1 << 12;
+  std::uint64_t n_;
+  std::uint64_t block_size_;
+  std::uint64_t seed_;
+  // '(' before the start of every block
+  std::vector<std::uint64_t> opened_;
+  std::uint64_t rotation_ = 0;
+  void locate_rotation();
+  void emit(std::uint64_t from, std::uint64_t to, std::vector<char> &buf, const sink_type &sink) const;
+ public:
+  ExternalBrackSeq(std::uint64_t n, size_t memory_budget, std::uint64_t seed);
+  ~ExternalBrackSeq() override = default;
+  // streams the 2n characters to "sink", one block at a time
+  void generate(const sink_type &sink);
+  void generate(std::ostream& os) override;
+};
+
+#endif //GENTREE_BRACKET_SEQUENCES_EXTERNAL_BRACKET_SEQ_H_
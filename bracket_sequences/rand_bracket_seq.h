@@ -3,19 +3,95 @@
 
 #include "rand_bracket_seq_iface.h"
 
+#include "bp_sink.h"
+#include "phase_stats.h"
 #include "rand_utils.h"
 
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <stack>
+#include <string>
+#include <utility>
+
 class RandomBrackSeqImpl : public IRandomBrackSeq {
  private:
   rand_utils utils_;
-  static std::string explicit_stack_phi(const std::string &w);
-  std::string random_bps(size_t n);
+  // n '(' and n ')' in random order
+  std::string random_word(size_t n);
   size_t n_;
-  static bool is_balanced(const std::string &s);
  public:
   ~RandomBrackSeqImpl() override = default;
   explicit RandomBrackSeqImpl(size_t n);
+  RandomBrackSeqImpl(size_t n, std::uint64_t seed);
+  // maps a sequence of n '(' and n ')' to a balanced one (cycle-lemma bijection), pushed to "sink"
+  template<typename Sink>
+  static void phi(const std::string &w, Sink &sink);
+  static std::string explicit_stack_phi(const std::string &w);
+  static bool is_balanced(const std::string &s);
+  // a fresh random sequence of n pairs, pushed to "sink" (bp_sink.h)
+  template<typename Sink>
+  void generate_to(Sink &sink);
   void generate(std::ostream& os) override;
+  // a fresh random sequence of n pairs, kept in memory
+  std::string sequence();
 };
 
-#endif //GENTREE__RAND_BINTREE_H_
\ No newline at end of file
+template<typename Sink>
+void RandomBrackSeqImpl::phi(const std::string &w, Sink &sink) {
+  if ( w.empty() )
+    return ;
+  size_t n= w.size()/2;
+  std::stack<std::optional<std::pair<size_t,size_t>>> post_action;
+  std::stack<size_t> ls, rs;
+  std::stack<bool> status;
+  auto enc= [&]( size_t x, size_t y, bool tf, std::optional<std::pair<size_t,size_t>> opt ) {
+    ls.push(x),rs.push(y),status.push(tf),post_action.push(opt);
+  };
+  enc(0,2*n-1,false,std::nullopt);
+  while ( not ls.empty() ) {
+    auto left= ls.top(), right= rs.top();
+    ls.pop(), rs.pop();
+    std::int64_t partial_sum= 0;
+    size_t i,r= 0;
+    bool done= status.top(); status.pop();
+    auto action= post_action.top(); post_action.pop();
+    if ( done ) {
+      if ( action ) {
+        sink.close();
+        for ( auto k= action.value().first+1; k <= action.value().second-2; ++k ) {
+          if ( w[k] == '(' ) sink.close(); else sink.open();
+        }
+      }
+      continue ;
+    }
+    enc(left,right,true,action);
+    for ( i= left; i <= right and r == 0; ++i )
+      if ( (partial_sum+= (w[i]=='('?1:-1)) == 0 )
+        r= i+1;
+    if ( left > right ) continue ;
+    assert( r > 0 );
+    if ( w[left] == '(' ) {
+      for ( i= left; i < r; ++i ) {
+        if ( w[i] == '(' ) sink.open(); else sink.close();
+      }
+      enc(r,right,false,std::nullopt);
+      continue ;
+    }
+    assert( w[left] == ')' );
+    assert( w[r-1] == '(' );
+    sink.open();
+    enc(r,right,false,std::make_pair(left,r));
+  }
+}
+
+template<typename Sink>
+void RandomBrackSeqImpl::generate_to(Sink &sink) {
+  const auto w = random_word(n_ - 1);
+  ScopedPhase phase("phi");
+  sink.open();
+  phi(w, sink);
+  sink.close();
+}
+
+#endif //GENTREE__RAND_BINTREE_H_
@@ -0,0 +1,89 @@
+#include "ordinal_tree_io.h"
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <stack>
+
+void convert(const std::string& s, random_ordinal_tree::ordinal_tree& tree) {
+  const auto n = s.size() / 2;
+  for(int i= 0; i < n; ++i) {
+    tree.add_adj();
+  }
+  std::stack<unsigned int> st;
+  auto V= 0ULL;
+  for (auto ch : s) {
+    if(ch == ')') {
+      assert(not st.empty());
+      const auto x = st.top();
+      st.pop();
+      if(not st.empty()) {
+        tree.mutable_adj(st.top())->add_to(x);
+      }
+    } else {
+      assert(ch == '(');
+      st.push(V++);
+    }
+  }
+  assert(st.empty());
+  assert(V == n);
+}
+
+void print_bp(std::ostream &os, const std::string &bps,
+              const std::vector<std::int64_t> *weights) {
+  os << bps << '\n';
+  if (weights and not weights->empty()) {
+    int wid = 0;
+    for (auto x : *weights) {
+      os << x << ' ';
+      if (++wid >= 80) {
+        wid = 0;
+        os << '\n';
+      }
+    }
+    os << '\n';
+  }
+}
+
+namespace {
+
+  template<typename Id>
+  void write_edges(std::ostream &os, const random_ordinal_tree::ordinal_tree& tree, std::uint64_t dx) {
+    constexpr size_t kBatch = 1 << 12;
+    Id buf[2*kBatch];
+    size_t len = 0;
+    for(int x = 0; x < tree.adj_size(); ++x) {
+      for(auto j = 0; j < tree.adj(x).to_size(); ++j) {
+        buf[len++] = static_cast<Id>(x + dx);
+        buf[len++] = static_cast<Id>(tree.adj(x).to(j) + dx);
+        if (len == 2*kBatch) {
+          os.write(reinterpret_cast<const char*>(buf), len*sizeof(Id)), len = 0;
+        }
+      }
+    }
+    os.write(reinterpret_cast<const char*>(buf), len*sizeof(Id));
+  }
+
+} // namespace
+
+void write_binary(std::ostream &os,
+                  const random_ordinal_tree::ordinal_tree& tree,
+                  const std::vector<std::int64_t> *weights,
+                  std::uint64_t dx) {
+  const std::uint64_t n = tree.adj_size();
+  const bool has_weights = weights and not weights->empty();
+  BinaryTreeHeader header{};
+  std::memcpy(header.magic, kBinaryTreeMagic, sizeof header.magic);
+  header.id_bytes = n + dx <= std::numeric_limits<std::uint32_t>::max() ? 4 : 8;
+  header.n = n, header.dx = dx, header.has_weights = has_weights;
+  os.write(reinterpret_cast<const char*>(&header), sizeof header);
+  if (has_weights) {
+    assert(weights->size() == n);
+    os.write(reinterpret_cast<const char*>(weights->data()), n*sizeof(std::int64_t));
+  }
+  if (header.id_bytes == 4) {
+    write_edges<std::uint32_t>(os, tree, dx);
+  } else {
+    write_edges<std::uint64_t>(os, tree, dx);
+  }
+}
@@ -0,0 +1,55 @@
+#ifndef GENTREE_IPC_ORDINAL_TREE_IO_H_
+#define GENTREE_IPC_ORDINAL_TREE_IO_H_
+
+#include "ordinal_tree.pb.h"
+#include "tree_format.h"
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Builds the adjacency lists of "tree" from a balanced parentheses sequence;
+// nodes are numbered in preorder, the root being 0
+void convert(const std::string& s, random_ordinal_tree::ordinal_tree& tree);
+
+// Writes the tree as "n", an optional line of weights, and then
+// one "parent child" edge per line, with node ids shifted by "dx"
+template<typename T>
+void print(std::ostream &os,
+           const random_ordinal_tree::ordinal_tree& tree,
+           std::optional<T> weights= std::nullopt,
+           std::uint64_t dx= 0) {
+  os << tree.adj_size() << '\n';
+  if(weights) {
+    auto &p = *weights;
+    int wid = 0;
+    for (auto x : p) {
+      os << x << ' ';
+      if (++wid >= 80) {
+        wid = 0;
+        os << '\n';
+      }
+    }
+    os << '\n';
+  }
+  for(int x = 0; x < tree.adj_size(); ++x) {
+    for(auto j = 0; j < tree.adj(x).to_size(); ++j) {
+      const auto y= tree.adj(x).to(j);
+      os << x+dx << ' ' << y+dx << '\n';
+    }
+  }
+}
+
+// Writes the balanced parentheses sequence "bps" on one line, followed by a line of weights if any
+void print_bp(std::ostream &os, const std::string &bps,
+              const std::vector<std::int64_t> *weights= nullptr);
+
+// Writes the tree in TreeFormat::kBinary: header, weights (if any), then (parent, child) ids shifted by "dx"
+void write_binary(std::ostream &os,
+                  const random_ordinal_tree::ordinal_tree& tree,
+                  const std::vector<std::int64_t> *weights= nullptr,
+                  std::uint64_t dx= 0);
+
+#endif //GENTREE_IPC_ORDINAL_TREE_IO_H_
@@ -1,105 +1,548 @@
 #include "ordinal_tree.pb.h"
+#include "ordinal_tree_io.h"
 #include "rand_ordinal_tree_iface.h"
+#include "boltzmann_ordinal_tree.h"
+#include "external_tree_writer.h"
+#include "lazy_ordinal_tree.h"
+#include "prufer_tree.h"
 #include "rand_ordinal_tree_from_bps.h"
+#include "relabel.h"
+#include "tree_enumerator.h"
+#include "tree_fingerprint.h"
+#include "unranked_ordinal_tree.h"
+#include "phase_stats.h"
+#include "rand_utils.h"
+#include "async_writer.h"
+#include "buffered_writer.h"
+#include "tree_format.h"
 
 #include "gflags/gflags.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <functional>
 #include <iostream>
-#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <ostream>
 #include <random>
 #include <sstream>
-#include <stack>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 DEFINE_uint64(n, 1ull, "n the tree size to generate");
 DEFINE_uint64(dx, 0ull, "start from 1 or 0?");
 DEFINE_string(output, "", "output path");
 DEFINE_uint64(a, 1ull, "lower bound on weights (inclusive)");
 DEFINE_uint64(b, 0ull, "upper bound on weights (inclusive)");
+DEFINE_uint64(max_degree, 0ull, "bound on the number of children of a node (0: unbounded)");
+DEFINE_string(degree_weights, "", "comma-separated weights w0,w1,...,wd of nodes with 0..d children (e.g. 1,0,1 for full binary trees)");
+DEFINE_double(size_tolerance, 0.0, "accept any size within n(1 -/+ tolerance); needs degree constraints");
+DEFINE_uint64(max_height, 0ull, "bound on the height of the tree (0: unbounded); needs degree constraints");
+DEFINE_uint64(external_memory_mib, 0ull, "generate out of core within this many MiB of RAM, streaming to -output (0: in memory)");
+DEFINE_string(bp_output, "", "with -external_memory_mib, also stream the parentheses sequence to this path");
+DEFINE_uint64(walks, 0ull, "print this many random root-to-leaf walks of a lazily expanded tree instead of the tree");
+DEFINE_string(format, "text", "output format: text (edge list), bp (parentheses) or binary");
+DEFINE_string(labels, "preorder", "node ids: preorder, bfs, postorder or random (the bp format has no ids)");
+DEFINE_uint64(threads, 0ull, "threads for relabeling and for -count batches (0: all cores)");
+DEFINE_uint64(count, 1ull, "number of trees to generate, written one after another");
+DEFINE_string(dedup, "none", "drop repeated shapes among the -count trees: none, ordinal or unordered");
+DEFINE_bool(free, false, "write a uniformly random labeled free tree instead, decoded from a random Prüfer sequence and rooted at node n-1");
+DEFINE_bool(enumerate, false, "write every ordinal tree with -n nodes instead of random ones");
+DEFINE_string(unrank_range, "", "write the trees of indices [a,b) among all ordinal trees with -n <= 70 nodes, as \"[a,b)\" or \"a,b\"");
+DEFINE_bool(unrank_random, false, "draw every tree as the tree of one uniformly random index (-n <= 70)");
+DEFINE_string(stats, "", "write per-phase timings and memory usage as JSON to this path");
 
-template<typename T>
-void print(std::ostream &os,
-           const random_ordinal_tree::ordinal_tree& tree,
-           std::optional<T> weights= std::nullopt) {
-  os << tree.adj_size() << '\n';
-  if(weights) {
-    auto &p = *weights;
-    int wid = 0;
-    for (auto x : p) {
-      os << x << ' ';
-      if (++wid >= 80) {
-        wid = 0;
-        os << '\n';
+// The degree weights asked for through --max_degree/--degree_weights, if any; throws
+// std::invalid_argument unless they are numbers, none negative and not all zero
+std::optional<std::vector<double>> requested_degree_weights() {
+  if (not FLAGS_degree_weights.empty()) {
+    const auto bad = std::invalid_argument("bad -degree_weights " + FLAGS_degree_weights
+                                           + ": expected non-negative numbers, not all zero");
+    std::vector<double> w;
+    std::istringstream is(FLAGS_degree_weights);
+    for (std::string item; std::getline(is, item, ',');) {
+      size_t used = 0;
+      try {
+        w.push_back(std::stod(item, &used));
+      } catch (const std::exception&) {
+        throw bad;
       }
+      if (used != item.size() or not std::isfinite(w.back()) or w.back() < 0) {
+        throw bad;
+      }
+    }
+    if (std::none_of(w.begin(), w.end(), [](double x) { return x > 0; })) {
+      throw bad;
     }
-    os << '\n';
+    return w;
+  }
+  if (FLAGS_max_degree > 0) {
+    return std::vector<double>(FLAGS_max_degree + 1, 1.0);
   }
-  for(int x = 0; x < tree.adj_size(); ++x) {
-    for(auto j = 0; j < tree.adj(x).to_size(); ++j) {
-      const auto y= tree.adj(x).to(j);
-      os << x+FLAGS_dx << ' ' << y+FLAGS_dx << '\n';
+  return std::nullopt;
+}
+
+// Renames the nodes of "tree" in place, keeping the children of every node in order
+void relabel_tree(random_ordinal_tree::ordinal_tree &tree, LabelOrder order, std::uint64_t seed, unsigned threads) {
+  std::vector<std::uint32_t> parents(tree.adj_size(), 0);
+  for (int x = 0; x < tree.adj_size(); ++x) {
+    for (auto y : tree.adj(x).to()) {
+      parents[y] = x;
     }
   }
+  const auto edges = relabel_edges(parents, make_labels(parents, order, seed, threads), threads);
+  for (auto &adj : *tree.mutable_adj()) {
+    adj.clear_to();
+  }
+  for (const auto &[x, y] : edges) {
+    tree.mutable_adj(x)->add_to(y);
+  }
 }
 
-void convert(const std::string& s, random_ordinal_tree::ordinal_tree& tree) {
-  const auto n = s.size() / 2;
-  for(int i= 0; i < n; ++i) {
-    tree.add_adj();
-  }
-  std::stack<unsigned int> st;
-  auto V= 0ULL;
-  for (auto ch : s) {
-    if(ch == ')') {
-      assert(not st.empty());
-      const auto x = st.top();
-      st.pop();
-      if(not st.empty()) {
-        tree.mutable_adj(st.top())->add_to(x);
+// Generates "count" trees on "threads" threads, in order; with "dedup", only
+// the first tree of every shape is kept (which one is first depends on the scheduling)
+std::vector<std::string> generate_batch(
+    const std::function<std::unique_ptr<IRandomOrdinalTree>(std::optional<std::uint64_t>)> &make_tree,
+    std::uint64_t count, std::optional<TreeShape> dedup, std::uint64_t seed, unsigned threads) {
+  std::vector<std::string> trees(count);
+  std::optional<FingerprintSet> seen;
+  if (dedup) {
+    seen.emplace(count);
+  }
+  std::atomic<std::uint64_t> next{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto work = [&] {
+    try {
+      for (std::uint64_t i; (i = next.fetch_add(1)) < count;) {
+        std::stringstream ss;
+        make_tree(seed + i * 0x9e3779b97f4a7c15ull)->generate(ss);
+        auto bps = ss.str();
+        if (not seen or seen->insert(tree_fingerprint(bps, *dedup))) {
+          trees[i] = std::move(bps);
+        }
       }
-    } else {
-      assert(ch == '(');
-      st.push(V++);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      error = std::current_exception();
+      next = count;
     }
+  };
+  // all on workers, so that the generators' own phases stay out of the stats
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < std::min<std::uint64_t>(threads, count); ++t) {
+    workers.emplace_back(work);
   }
-  assert(st.empty());
-  assert(V == n);
+  for (auto &w : workers) {
+    w.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  trees.erase(std::remove(trees.begin(), trees.end(), std::string()), trees.end());
+  return trees;
 }
 
-int main(int argc, char **argv) {
-  gflags::SetUsageMessage("Usage: otree -n <num of nodes> -d <0-or 1-based> -output <output-path> -a <weights-lower> -b <weights-upper>");
-  gflags::ParseCommandLineFlags(&argc,&argv,/*remove_flags=*/true);
-
-  auto requested = FLAGS_n;
-  std::unique_ptr<IRandomOrdinalTree> rand_tree = std::make_unique<RandOrdinalTreeFromBinary>(requested);
-  std::stringstream ss;
-  rand_tree->generate(ss);
-
+// Writes the tree with balanced parentheses "bps" in "format", with the --labels ids and --a/--b weights
+void write_tree(std::ostream &os, const std::string &bps, TreeFormat format, LabelOrder labels, unsigned threads) {
+  if (format == TreeFormat::kBP) {
+    // the parentheses carry no ids and need no conversion
+    std::vector<std::int64_t> weights;
+    if (FLAGS_a <= FLAGS_b) {
+      ScopedPhase phase("weights");
+      std::random_device dev;
+      weights = rand_utils::rand_weights(bps.size() / 2, FLAGS_a, FLAGS_b, dev());
+    }
+    ScopedPhase phase("print");
+    print_bp(os, bps, &weights);
+    return ;
+  }
   random_ordinal_tree::ordinal_tree proto_msg;
   proto_msg.Clear();
-  convert(ss.str(), proto_msg);
+  {
+    ScopedPhase phase("convert");
+    convert(bps, proto_msg);
+  }
+  if (labels != LabelOrder::kPreorder) {
+    std::random_device dev;
+    relabel_tree(proto_msg, labels, (static_cast<std::uint64_t>(dev()) << 32) | dev(), threads);
+  }
 
   std::vector<std::int64_t> weights;
   if(FLAGS_a <= FLAGS_b) {
     // assign weights
-    weights.resize(FLAGS_n);
+    ScopedPhase phase("weights");
+    std::random_device dev;
+    weights = rand_utils::rand_weights(proto_msg.adj_size(), FLAGS_a, FLAGS_b, dev());
+  }
+
+  ScopedPhase phase("print");
+  switch (format) {
+    case TreeFormat::kText:
+      print(os, proto_msg, weights.empty() ? std::nullopt : std::make_optional(weights), FLAGS_dx);
+      break ;
+    case TreeFormat::kBinary:
+      write_binary(os, proto_msg, &weights, FLAGS_dx);
+      break ;
+    default:
+      assert(false);
+  }
+}
+
+// Writes the preorder tree of "parents" (the root's entry is ignored) in kText or kBinary, byte for
+// byte as write_tree would, straight from the parent array: edges grouped by parent, in order.
+// "children" is scratch space, reused across calls.
+void write_parents(BufferedWriter &out, const std::vector<std::uint32_t> &parents, TreeFormat format,
+                   const std::vector<std::int64_t> &weights, std::vector<std::uint32_t> &children) {
+  const std::uint64_t n = parents.size();
+  // children[start[x]..start[x+1]) are those of x; in preorder they come in increasing order
+  children.assign(2 * n + 1, 0);
+  auto *start = children.data() + n;
+  for (std::uint64_t v = 1; v < n; ++v) {
+    ++start[parents[v] + 1];
+  }
+  for (std::uint64_t x = 0; x < n; ++x) {
+    start[x + 1] += start[x];
+  }
+  for (std::uint64_t v = 1; v < n; ++v) {
+    children[start[parents[v]]++] = static_cast<std::uint32_t>(v);
+  }
+  const std::uint64_t dx = FLAGS_dx;
+  if (format == TreeFormat::kText) {
+    out.write_uint(n), out.put('\n');
+    if (not weights.empty()) {
+      int wid = 0;
+      for (auto x : weights) {
+        out.write_int(x), out.put(' ');
+        if (++wid >= 80) {
+          wid = 0;
+          out.put('\n');
+        }
+      }
+      out.put('\n');
+    }
+    for (std::uint64_t i = 0; i + 1 < n; ++i) {
+      out.write_uint(parents[children[i]] + dx), out.put(' ');
+      out.write_uint(children[i] + dx), out.put('\n');
+    }
+    return ;
+  }
+  assert(format == TreeFormat::kBinary);
+  BinaryTreeHeader header{};
+  std::memcpy(header.magic, kBinaryTreeMagic, sizeof header.magic);
+  header.id_bytes = n + dx <= std::numeric_limits<std::uint32_t>::max() ? 4 : 8;
+  header.n = n, header.dx = dx, header.has_weights = not weights.empty();
+  out.write_raw(header);
+  out.write(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(std::int64_t));
+  for (std::uint64_t i = 0; i + 1 < n; ++i) {
+    const std::uint64_t x = parents[children[i]] + dx, y = children[i] + dx;
+    if (header.id_bytes == 4) {
+      out.write_raw(static_cast<std::uint32_t>(x)), out.write_raw(static_cast<std::uint32_t>(y));
+    } else {
+      out.write_raw(x), out.write_raw(y);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  gflags::SetUsageMessage("Usage: otree -n <num of nodes> -d <0-or 1-based> -output <output-path> -a <weights-lower> -b <weights-upper> -format <text|bp|binary>");
+  gflags::ParseCommandLineFlags(&argc,&argv,/*remove_flags=*/true);
+  const auto format = parse_tree_format(FLAGS_format);
+  if (not format) {
+    std::cerr << "unknown format " << FLAGS_format << std::endl;
+    return 1;
+  }
+  const auto labels = parse_label_order(FLAGS_labels);
+  if (not labels) {
+    std::cerr << "unknown labels " << FLAGS_labels << std::endl;
+    return 1;
+  }
+  std::optional<std::vector<double>> degree_weights;
+  try {
+    degree_weights = requested_degree_weights();
+  } catch (const std::invalid_argument &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  if (not FLAGS_stats.empty()) {
+    PhaseStats::instance().enable("otree");
+  }
+  // every output goes through an AsyncOstream, closed (and checked) by finish()
+  std::unique_ptr<AsyncOstream> out, bp_out;
+  auto open_output = [](const std::string &path, std::unique_ptr<AsyncOstream> &stream) {
+    try {
+      stream = std::make_unique<AsyncOstream>(path);
+      return true;
+    } catch (const std::runtime_error &e) {
+      std::cerr << e.what() << std::endl;
+      return false;
+    }
+  };
+  auto finish = [&]() {
+    for (auto *stream : {out.get(), bp_out.get()}) {
+      try {
+        if (stream) {
+          stream->close();
+        }
+      } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+      }
+    }
+    if (not FLAGS_stats.empty() and not PhaseStats::instance().write_json(FLAGS_stats)) {
+      std::cerr << "cannot write stats to " << FLAGS_stats << std::endl;
+      return 1;
+    }
+    return 0;
+  };
+
+  if (FLAGS_walks > 0) {
+    // Only the nodes on the walks (and their siblings) are ever generated
+    ScopedPhase phase("walks");
+    std::random_device dev;
+    const LazyOrdinalTree tree(FLAGS_n, (static_cast<std::uint64_t>(dev()) << 32) | dev());
+    std::mt19937_64 rng(dev());
+    if (not open_output(FLAGS_output, out)) {
+      return 1;
+    }
+    std::ostream &os = *out;
+    for (std::uint64_t w = 0; w < FLAGS_walks; ++w) {
+      auto x = tree.root();
+      os << x.id + FLAGS_dx;
+      for (auto children = tree.children(x); not children.empty(); children = tree.children(x)) {
+        x = children[std::uniform_int_distribution<size_t>(0, children.size() - 1)(rng)];
+        os << ' ' << x.id + FLAGS_dx;
+      }
+      os << '\n';
+    }
+    return finish();
+  }
+
+  if (FLAGS_free) {
+    // The ids are the labels of the tree, so they are not renamed
+    if (*format == TreeFormat::kBP or *labels != LabelOrder::kPreorder) {
+      std::cerr << "-free writes its own ids, as text or binary" << std::endl;
+      return 1;
+    }
+    if (degree_weights or FLAGS_size_tolerance > 0 or FLAGS_max_height > 0 or FLAGS_external_memory_mib > 0
+        or FLAGS_count != 1 or FLAGS_enumerate or FLAGS_unrank_range != "" or FLAGS_unrank_random) {
+      std::cerr << "-free writes a single unconstrained tree" << std::endl;
+      return 1;
+    }
+    const unsigned threads = FLAGS_threads > 0 ? FLAGS_threads : std::max(1u, std::thread::hardware_concurrency());
+    std::random_device dev;
+    std::vector<std::uint32_t> parents;
+    try {
+      ScopedPhase phase("prufer");
+      parents = random_free_tree(FLAGS_n, (static_cast<std::uint64_t>(dev()) << 32) | dev(), threads);
+    } catch (const std::invalid_argument &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    std::vector<std::int64_t> weights;
+    if (FLAGS_a <= FLAGS_b) {
+      ScopedPhase phase("weights");
+      weights = rand_utils::rand_weights(parents.size(), FLAGS_a, FLAGS_b, dev());
+    }
+    if (not open_output(FLAGS_output, out)) {
+      return 1;
+    }
+    {
+      ScopedPhase phase("print");
+      write_parent_tree(*out, parents, *format, &weights, FLAGS_dx, threads);
+    }
+    return finish();
+  }
+
+  if (FLAGS_external_memory_mib > 0) {
+    if (degree_weights or FLAGS_size_tolerance > 0 or FLAGS_max_height > 0) {
+      std::cerr << "-external_memory_mib only generates unconstrained trees" << std::endl;
+      return 1;
+    }
+    if (*labels != LabelOrder::kPreorder) {
+      std::cerr << "-external_memory_mib only writes preorder ids" << std::endl;
+      return 1;
+    }
+    if (FLAGS_count != 1) {
+      std::cerr << "-external_memory_mib writes a single tree" << std::endl;
+      return 1;
+    }
     std::random_device dev;
-    std::mt19937 rng(dev());
-    std::uniform_int_distribution<std::mt19937::result_type> dist(FLAGS_a,FLAGS_b);
-    for(auto &x : weights)
-      x = dist(rng);
+    ExternalTreeOptions options;
+    options.n = FLAGS_n;
+    options.memory_budget = FLAGS_external_memory_mib << 20;
+    options.seed = (static_cast<std::uint64_t>(dev()) << 32) | dev();
+    options.format = *format;
+    options.dx = FLAGS_dx;
+    if (FLAGS_a <= FLAGS_b) {
+      options.weights = std::make_pair(FLAGS_a, FLAGS_b);
+      options.weight_seed = dev();
+    }
+    if (not open_output(FLAGS_output, out) or (FLAGS_bp_output != "" and not open_output(FLAGS_bp_output, bp_out))) {
+      return 1;
+    }
+    try {
+      ScopedPhase phase("external");
+      write_external_tree(options, *out, bp_out.get());
+    } catch (const std::invalid_argument &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    return finish();
+  }
+
+  const unsigned threads = FLAGS_threads > 0 ? FLAGS_threads : std::max(1u, std::thread::hardware_concurrency());
+  if (not open_output(FLAGS_output, out)) {
+    return 1;
   }
+  std::ostream &os = *out;
 
-  if ( FLAGS_output != "" ) {
-    std::ofstream ofs;
-    ofs.open(FLAGS_output );
-    print(ofs, proto_msg, weights.empty() ? std::nullopt : std::make_optional(weights));
-    ofs.close();
+  const bool by_rank = FLAGS_unrank_random or FLAGS_unrank_range != "";
+  if ((FLAGS_enumerate or by_rank) and (degree_weights or FLAGS_size_tolerance > 0 or FLAGS_max_height > 0)) {
+    std::cerr << "-enumerate, -unrank_range and -unrank_random only cover unconstrained trees" << std::endl;
+    return 1;
   }
-  else {
-    std::ostream &os= std::cout;
-    print(os, proto_msg, weights.empty() ? std::nullopt : std::make_optional(weights));
-    os << std::endl;
+  if ((FLAGS_enumerate or FLAGS_unrank_range != "") and FLAGS_count != 1) {
+    std::cerr << "-enumerate and -unrank_range do not take -count" << std::endl;
+    return 1;
   }
+
+  if (FLAGS_unrank_range != "") {
+    auto range = FLAGS_unrank_range;
+    if (range.front() == '[') {
+      range.erase(0, 1);
+    }
+    if (not range.empty() and range.back() == ')') {
+      range.pop_back();
+    }
+    const auto comma = range.find(',');
+    const auto a = BrackSeqRanker::parse_rank(range.substr(0, comma));
+    const auto b = comma == std::string::npos ? std::nullopt : BrackSeqRanker::parse_rank(range.substr(comma + 1));
+    if (not a or not b or *a > *b) {
+      std::cerr << "bad -unrank_range " << FLAGS_unrank_range << std::endl;
+      return 1;
+    }
+    try {
+      ScopedPhase phase("unrank");
+      const BrackSeqRanker ranker(FLAGS_n > 0 ? FLAGS_n - 1 : 0);
+      if (*b > ranker.count()) {
+        std::cerr << "there are only " << BrackSeqRanker::to_string(ranker.count()) << " trees with " << FLAGS_n << " nodes" << std::endl;
+        return 1;
+      }
+      std::string inner, bps;
+      for (auto k = *a; k < *b; ++k) {
+        ranker.unrank(k, inner);
+        bps.assign(1, '(').append(inner).push_back(')');
+        write_tree(os, bps, *format, *labels, threads);
+        if (FLAGS_output == "" and *format == TreeFormat::kText) {
+          os << '\n';
+        }
+      }
+    } catch (const std::invalid_argument &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    return finish();
+  }
+
+  if (FLAGS_enumerate) {
+    try {
+      ScopedPhase phase("enumerate");
+      OrdinalTreeEnumerator trees(FLAGS_n);
+      if (*format == TreeFormat::kBP or *labels != LabelOrder::kPreorder) {
+        do {
+          write_tree(os, trees.bps(), *format, *labels, threads);
+          if (FLAGS_output == "" and *format == TreeFormat::kText) {
+            os << '\n';
+          }
+        } while (trees.next());
+      } else {
+        // the trees are many and small: formatted from their parent arrays, with no protobuf in between
+        BufferedWriter writer(os);
+        std::vector<std::uint32_t> parents, children;
+        std::vector<std::int64_t> weights;
+        std::random_device dev;
+        do {
+          trees.parents(parents);
+          if (FLAGS_a <= FLAGS_b) {
+            weights = rand_utils::rand_weights(parents.size(), FLAGS_a, FLAGS_b, dev());
+          }
+          write_parents(writer, parents, *format, weights, children);
+          if (FLAGS_output == "" and *format == TreeFormat::kText) {
+            writer.put('\n');
+          }
+        } while (trees.next());
+      }
+    } catch (const std::invalid_argument &e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    return finish();
+  }
+
+  std::function<std::unique_ptr<IRandomOrdinalTree>(std::optional<std::uint64_t>)> make_tree;
+  if (degree_weights) {
+    BoltzmannParams params;
+    params.degree_weights = std::move(*degree_weights);
+    params.n = FLAGS_n;
+    params.tolerance = FLAGS_size_tolerance;
+    params.max_height = FLAGS_max_height;
+    make_tree = [params](std::optional<std::uint64_t> seed) -> std::unique_ptr<IRandomOrdinalTree> {
+      return seed ? std::make_unique<BoltzmannOrdinalTree>(params, *seed) : std::make_unique<BoltzmannOrdinalTree>(params);
+    };
+  } else if (FLAGS_size_tolerance > 0 or FLAGS_max_height > 0) {
+    std::cerr << "--size_tolerance and --max_height need --max_degree or --degree_weights" << std::endl;
+    return 1;
+  } else if (FLAGS_unrank_random) {
+    make_tree = [](std::optional<std::uint64_t> seed) -> std::unique_ptr<IRandomOrdinalTree> {
+      return seed ? std::make_unique<UnrankedOrdinalTree>(FLAGS_n, *seed) : std::make_unique<UnrankedOrdinalTree>(FLAGS_n);
+    };
+  } else {
+    make_tree = [](std::optional<std::uint64_t> seed) -> std::unique_ptr<IRandomOrdinalTree> {
+      return seed ? std::make_unique<RandOrdinalTreeFromBinary>(FLAGS_n, *seed) : std::make_unique<RandOrdinalTreeFromBinary>(FLAGS_n);
+    };
+  }
+  std::optional<TreeShape> dedup;
+  if (FLAGS_dedup != "none") {
+    if (not (dedup = parse_tree_shape(FLAGS_dedup))) {
+      std::cerr << "unknown dedup " << FLAGS_dedup << std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<std::string> trees;
+  try {
+    ScopedPhase phase("generate");
+    if (FLAGS_count == 1 and not dedup) {
+      auto rand_tree = make_tree(std::nullopt);
+      ScopedPhase serialize_phase("serialize");
+      std::stringstream ss;
+      rand_tree->generate(ss);
+      trees.push_back(ss.str());
+    } else {
+      std::random_device dev;
+      trees = generate_batch(make_tree, FLAGS_count, dedup, (static_cast<std::uint64_t>(dev()) << 32) | dev(), threads);
+    }
+  } catch (const std::invalid_argument& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  for (const auto &bps : trees) {
+    write_tree(os, bps, *format, *labels, threads);
+    if (FLAGS_output == "" and *format == TreeFormat::kText) {
+      os << '\n';
+    }
+  }
+
+  return finish();
 }
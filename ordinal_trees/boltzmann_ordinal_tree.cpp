@@ -0,0 +1,235 @@
+#include "boltzmann_ordinal_tree.h"
+
+#include "phase_stats.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+  // Height of the tree whose preorder degree sequence is "degrees"
+  size_t height_of(const std::vector<std::uint32_t>& degrees) {
+    std::vector<std::uint32_t> pending;
+    size_t height = 0;
+    for (auto k : degrees) {
+      if (not pending.empty()) {
+        --pending.back();
+      }
+      if (k > 0) {
+        pending.push_back(k);
+        height = std::max(height, pending.size());
+      }
+      while (not pending.empty() and pending.back() == 0) {
+        pending.pop_back();
+      }
+    }
+    return height;
+  }
+
+  // Whether some tree of the family has exactly "size" nodes,
+  // i.e. size-1 is a sum of degrees with a positive weight
+  class SizeOracle {
+    std::uint64_t gcd_ = 0;
+    std::vector<bool> small_;
+   public:
+    explicit SizeOracle(const std::vector<double>& w) {
+      std::vector<size_t> support;
+      for (size_t k = 1; k < w.size(); ++k) {
+        if (w[k] > 0) {
+          support.push_back(k), gcd_ = std::gcd(gcd_, k);
+        }
+      }
+      // beyond the Frobenius number every multiple of the gcd is reachable
+      const auto bound = (w.size() - 1) * (w.size() - 1) + 1;
+      small_.assign(bound, false), small_[0] = true;
+      for (size_t s = 1; s < bound; ++s) {
+        for (auto k : support) {
+          if (k <= s and small_[s-k]) {
+            small_[s] = true;
+            break ;
+          }
+        }
+      }
+    }
+    bool operator()(std::uint64_t size) const {
+      const auto target = size - 1;
+      return target < small_.size() ? small_[target] : target % gcd_ == 0;
+    }
+  };
+
+} // namespace
+
+std::vector<double> BoltzmannOrdinalTree::critical_offspring(const std::vector<double>& w) {
+  if (w.empty() or w[0] <= 0) {
+    throw std::invalid_argument("degree weights need a positive weight for leaves");
+  }
+  if (std::any_of(w.begin(), w.end(), [](double x) { return x < 0 or not std::isfinite(x); })) {
+    throw std::invalid_argument("degree weights must be finite and non-negative");
+  }
+  if (std::all_of(w.begin() + std::min<size_t>(2, w.size()), w.end(), [](double x) { return x == 0; })) {
+    throw std::invalid_argument("degree weights need a positive weight for some degree >= 2");
+  }
+  // The singular value tau of T = z*phi(T) solves phi(tau) = tau*phi'(tau),
+  // i.e. sum (1-k) w_k tau^k = 0, and the left side is decreasing in tau
+  auto g = [&w](double tau) {
+    double acc = 0, power = 1;
+    for (size_t k = 0; k < w.size(); ++k, power *= tau) {
+      acc += (1.0 - static_cast<double>(k)) * w[k] * power;
+    }
+    return acc;
+  };
+  double lo = 0, hi = 1;
+  for (; g(hi) > 0; hi *= 2) ;
+  for (int it = 0; it < 200; ++it) {
+    const auto mid = (lo + hi) / 2;
+    (g(mid) > 0 ? lo : hi) = mid;
+  }
+  const auto tau = (lo + hi) / 2;
+  std::vector<double> p(w.size());
+  double power = 1, phi = 0;
+  for (size_t k = 0; k < w.size(); ++k, power *= tau) {
+    phi += (p[k] = w[k] * power);
+  }
+  for (auto &x : p) {
+    x /= phi;
+  }
+  return p;
+}
+
+BoltzmannOrdinalTree::BoltzmannOrdinalTree(const BoltzmannParams& params)
+    : BoltzmannOrdinalTree(params, std::chrono::system_clock::now().time_since_epoch().count()) {}
+
+BoltzmannOrdinalTree::BoltzmannOrdinalTree(const BoltzmannParams& params, std::uint64_t seed)
+    : rng_(seed), params_(params) {
+  init();
+}
+
+void BoltzmannOrdinalTree::init() {
+  ScopedPhase phase("boltzmann");
+  offspring_ = critical_offspring(params_.degree_weights);
+  if (params_.n == 0 or params_.tolerance < 0 or params_.tolerance >= 1) {
+    throw std::invalid_argument("need n >= 1 and a tolerance in [0,1)");
+  }
+  const auto lo = std::max<size_t>(1, std::ceil(params_.n * (1 - params_.tolerance)));
+  const auto hi = static_cast<size_t>(std::floor(params_.n * (1 + params_.tolerance)));
+  const SizeOracle oracle(params_.degree_weights);
+  bool feasible = false;
+  for (auto size = lo; size <= hi and not feasible; ++size) {
+    feasible = oracle(size);
+  }
+  if (not feasible) {
+    throw std::invalid_argument("the degree weights admit no tree of " + std::to_string(lo)
+                                + (lo < hi ? ".." + std::to_string(hi) : "") + " nodes");
+  }
+  if (params_.max_height) {
+    // the largest tree of that height has sum d^i nodes
+    const auto d = static_cast<double>(params_.degree_weights.size() - 1);
+    double capacity = 0, level = 1;
+    for (size_t h = 0; h <= params_.max_height and capacity < lo; ++h, level *= d) {
+      capacity += level;
+    }
+    if (capacity < lo) {
+      throw std::invalid_argument("no tree of height <= " + std::to_string(params_.max_height)
+                                  + " has " + std::to_string(lo) + " nodes");
+    }
+  }
+  if (params_.tolerance > 0) {
+    while (not sample_window()) ;
+  } else {
+    while (not sample_exact()) ;
+  }
+}
+
+// One run of the critical Galton-Watson process, abandoned as soon as it
+// grows too large or too high (anticipated rejection)
+bool BoltzmannOrdinalTree::sample_window() {
+  const auto lo = std::max<size_t>(1, std::ceil(params_.n * (1 - params_.tolerance)));
+  const auto hi = static_cast<size_t>(std::floor(params_.n * (1 + params_.tolerance)));
+  std::discrete_distribution<std::uint32_t> offspring(offspring_.begin(), offspring_.end());
+  std::vector<std::uint32_t> pending;
+  degrees_.clear();
+  do {
+    if (not pending.empty()) {
+      --pending.back();
+    }
+    const auto k = offspring(rng_);
+    degrees_.push_back(k);
+    if (degrees_.size() > hi) {
+      return false;
+    }
+    if (k > 0) {
+      pending.push_back(k);
+      if (params_.max_height and pending.size() > params_.max_height) {
+        return false;
+      }
+    }
+    while (not pending.empty() and pending.back() == 0) {
+      pending.pop_back();
+    }
+  } while (not pending.empty());
+  return degrees_.size() >= lo;
+}
+
+// n i.i.d. degrees conditioned on summing to n-1 have multinomial counts
+// conditioned the same way, which only costs O(d) per attempt to draw;
+// the cycle lemma then turns the shuffled counts into a preorder degree sequence
+bool BoltzmannOrdinalTree::sample_exact() {
+  const auto n = params_.n;
+  const auto d = offspring_.size() - 1;
+  std::vector<std::uint64_t> counts(d + 1);
+  for (;;) {
+    std::uint64_t remaining = n, sum = 0;
+    double mass = 1;
+    for (size_t k = 0; k < d; ++k) {
+      const auto p = mass > 0 ? std::clamp(offspring_[k] / mass, 0.0, 1.0) : 1.0;
+      counts[k] = remaining ? std::binomial_distribution<std::uint64_t>(remaining, p)(rng_) : 0;
+      remaining -= counts[k], mass -= offspring_[k], sum += k * counts[k];
+    }
+    counts[d] = remaining, sum += d * remaining;
+    if (sum == n - 1) {
+      break ;
+    }
+  }
+  degrees_.clear();
+  degrees_.reserve(n);
+  for (size_t k = 0; k <= d; ++k) {
+    degrees_.insert(degrees_.end(), counts[k], static_cast<std::uint32_t>(k));
+  }
+  std::shuffle(degrees_.begin(), degrees_.end(), rng_);
+  // the rotation starting right after the first minimum of the prefix sums of (degree-1)
+  std::int64_t prefix = 0, lowest = std::numeric_limits<std::int64_t>::max();
+  size_t at = 0;
+  for (size_t i = 0; i < n; ++i) {
+    prefix += static_cast<std::int64_t>(degrees_[i]) - 1;
+    if (prefix < lowest) {
+      lowest = prefix, at = i;
+    }
+  }
+  std::rotate(degrees_.begin(), degrees_.begin() + at + 1, degrees_.end());
+  return params_.max_height == 0 or height_of(degrees_) <= params_.max_height;
+}
+
+size_t BoltzmannOrdinalTree::size() const {
+  return degrees_.size();
+}
+
+const std::vector<std::uint32_t>& BoltzmannOrdinalTree::degrees() const {
+  return degrees_;
+}
+
+void BoltzmannOrdinalTree::generate(std::ostream &os) {
+  TextSink sink(os);
+  generate_to(sink);
+}
+
+std::vector<std::uint32_t> BoltzmannOrdinalTree::parents() const {
+  ParentArraySink sink(degrees_.size());
+  generate_to(sink);
+  return sink.release();
+}
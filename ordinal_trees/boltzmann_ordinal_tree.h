@@ -0,0 +1,78 @@
+#ifndef GENTREE_ORDINAL_TREES_BOLTZMANN_ORDINAL_TREE_H_
+#define GENTREE_ORDINAL_TREES_BOLTZMANN_ORDINAL_TREE_H_
+
+#include "rand_ordinal_tree_iface.h"
+#include "bp_sink.h"
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <vector>
+
+struct BoltzmannParams {
+  // w_k, the weight of a node with k children (k = 0..d); {1,1,1} are the
+  // unary-binary trees, {1,0,1} the full binary ones
+  std::vector<double> degree_weights;
+  size_t n = 1;
+  // 0 asks for exactly n nodes; otherwise any size within n(1 -/+ tolerance) is accepted
+  double tolerance = 0;
+  // 0 for no bound; the root has height 0
+  size_t max_height = 0;
+};
+
+/**
+ * A random ordinal tree from the simply generated family given by the degree
+ * weights, drawn with probability proportional to the product of its nodes' weights
+ * (uniformly, for 0/1 weights) among the trees of its size.
+ * Sizes within a window come from a singular Boltzmann sampler (a critical
+ * Galton-Watson process) with anticipated rejection; exact sizes from the same
+ * offspring law, conditioned through its multinomial degree counts and the cycle lemma.
+ * Both take expected linear time. A height bound is enforced by rejection,
+ * so it is cheap only while it is not far below the typical height, ~sqrt(n).
+ * Throws std::invalid_argument if the family has no tree of an acceptable size.
+ */
+class BoltzmannOrdinalTree : public IRandomOrdinalTree {
+ private:
+  std::mt19937_64 rng_;
+  BoltzmannParams params_;
+  std::vector<double> offspring_;
+  // number of children of every node, in preorder
+  std::vector<std::uint32_t> degrees_;
+  void init();
+  bool sample_window();
+  bool sample_exact();
+ public:
+  explicit BoltzmannOrdinalTree(const BoltzmannParams& params);
+  BoltzmannOrdinalTree(const BoltzmannParams& params, std::uint64_t seed);
+  // the offspring law of the critical Galton-Watson process for "degree_weights"
+  static std::vector<double> critical_offspring(const std::vector<double>& degree_weights);
+  [[nodiscard]] size_t size() const;
+  [[nodiscard]] const std::vector<std::uint32_t>& degrees() const;
+  // pushes the tree's parentheses to "sink" (bp_sink.h)
+  template<typename Sink>
+  void generate_to(Sink &sink) const;
+  void generate(std::ostream& os) override;
+  [[nodiscard]] std::vector<std::uint32_t> parents() const override;
+};
+
+template<typename Sink>
+void BoltzmannOrdinalTree::generate_to(Sink &sink) const {
+  // children still to come of every node on the current path
+  std::vector<std::uint32_t> pending;
+  for (auto k : degrees_) {
+    if (not pending.empty()) {
+      --pending.back();
+    }
+    sink.open();
+    if (k > 0) {
+      pending.push_back(k);
+      continue ;
+    }
+    sink.close();
+    while (not pending.empty() and pending.back() == 0) {
+      pending.pop_back(), sink.close();
+    }
+  }
+}
+
+#endif //GENTREE_ORDINAL_TREES_BOLTZMANN_ORDINAL_TREE_H_
@@ -0,0 +1,121 @@
+#include "external_tree_writer.h"
+
+#include "buffered_writer.h"
+#include "external_bracket_seq.h"
+#include "phase_stats.h"
+
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+  void write_weights(const ExternalTreeOptions &options, BufferedWriter &out, bool binary) {
+    if (not options.weights) {
+      return ;
+    }
+    ScopedPhase phase("weights");
+    std::mt19937 rng(options.weight_seed);
+    std::uniform_int_distribution<std::mt19937::result_type> dist(options.weights->first,
+                                                                  options.weights->second);
+    int wid = 0;
+    for (std::uint64_t i = 0; i < options.n; ++i) {
+      const std::int64_t x = dist(rng);
+      if (binary) {
+        out.write_raw(x);
+        continue ;
+      }
+      out.write_int(x), out.put(' ');
+      if (++wid >= 80) {
+        wid = 0;
+        out.put('\n');
+      }
+    }
+    if (not binary) {
+      out.put('\n');
+    }
+  }
+
+  // Turns the parentheses into (parent, child) edges as they stream by,
+  // keeping only the path to the current node
+  class EdgeEmitter {
+    BufferedWriter &out_;
+    TreeFormat format_;
+    std::uint64_t dx_;
+    std::uint32_t id_bytes_;
+    std::vector<std::uint64_t> path_;
+    std::uint64_t V_ = 0;
+   public:
+    EdgeEmitter(BufferedWriter &out, TreeFormat format, std::uint64_t dx, std::uint32_t id_bytes)
+        : out_(out), format_(format), dx_(dx), id_bytes_(id_bytes) {}
+    void consume(const char *data, size_t len) {
+      for (size_t i = 0; i < len; ++i) {
+        if (data[i] == ')') {
+          path_.pop_back();
+          continue ;
+        }
+        if (not path_.empty()) {
+          edge(path_.back() + dx_, V_ + dx_);
+        }
+        path_.push_back(V_++);
+      }
+    }
+    void edge(std::uint64_t x, std::uint64_t y) {
+      if (format_ == TreeFormat::kText) {
+        out_.write_uint(x), out_.put(' '), out_.write_uint(y), out_.put('\n');
+      } else if (id_bytes_ == 4) {
+        out_.write_raw(static_cast<std::uint32_t>(x)), out_.write_raw(static_cast<std::uint32_t>(y));
+      } else {
+        out_.write_raw(x), out_.write_raw(y);
+      }
+    }
+  };
+
+} // namespace
+
+void write_external_tree(const ExternalTreeOptions &options, std::ostream &os, std::ostream *bp_os) {
+  // first, so that a budget too small for n is refused before anything is written
+  ExternalBrackSeq seq(options.n, options.memory_budget, options.seed);
+  BufferedWriter out(os);
+  std::optional<BufferedWriter> bp_out;
+  if (bp_os != nullptr) {
+    bp_out.emplace(*bp_os);
+  }
+  const auto id_bytes = options.n + options.dx <= std::numeric_limits<std::uint32_t>::max() ? 4u : 8u;
+  switch (options.format) {
+    case TreeFormat::kText:
+      out.write_uint(options.n), out.put('\n');
+      write_weights(options, out, false);
+      break ;
+    case TreeFormat::kBinary: {
+      BinaryTreeHeader header{};
+      std::memcpy(header.magic, kBinaryTreeMagic, sizeof header.magic);
+      header.id_bytes = id_bytes;
+      header.n = options.n, header.dx = options.dx, header.has_weights = options.weights.has_value();
+      out.write_raw(header);
+      write_weights(options, out, true);
+      break ;
+    }
+    case TreeFormat::kBP:
+      break ;
+  }
+  EdgeEmitter edges(out, options.format, options.dx, id_bytes);
+  seq.generate([&](const char *data, size_t len) {
+    if (options.format == TreeFormat::kBP) {
+      out.write(data, len);
+    } else {
+      edges.consume(data, len);
+    }
+    if (bp_out) {
+      bp_out->write(data, len);
+    }
+  });
+  if (bp_out) {
+    bp_out->put('\n');
+  }
+  if (options.format == TreeFormat::kBP) {
+    out.put('\n');
+    write_weights(options, out, false);
+  }
+}
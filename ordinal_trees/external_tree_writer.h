@@ -0,0 +1,33 @@
+#ifndef GENTREE_ORDINAL_TREES_EXTERNAL_TREE_WRITER_H_
+#define GENTREE_ORDINAL_TREES_EXTERNAL_TREE_WRITER_H_
+
+#include "tree_format.h"
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <utility>
+
+struct ExternalTreeOptions {
+  std::uint64_t n = 1;
+  // bytes of RAM the generation may use, besides O(height) for the edge list
+  size_t memory_budget = size_t{256} << 20;
+  std::uint64_t seed = 0;
+  TreeFormat format = TreeFormat::kText;
+  std::uint64_t dx = 0;
+  // inclusive range of the weights, if any
+  std::optional<std::pair<std::uint64_t, std::uint64_t>> weights;
+  std::uint64_t weight_seed = 0;
+};
+
+/**
+ * Streams a uniformly random ordinal tree of any size, in "options.format", to "os"
+ * (and its balanced parentheses sequence to "bp_os" when given), with bounded RAM
+ * and sequential writes only. The layout is that of otree's formats, but the edges come
+ * in DFS preorder of the children rather than grouped by parent.
+ * Throws std::invalid_argument when the memory budget is too small for n.
+ */
+void write_external_tree(const ExternalTreeOptions &options, std::ostream &os,
+                         std::ostream *bp_os= nullptr);
+
+#endif //GENTREE_ORDINAL_TREES_EXTERNAL_TREE_WRITER_H_
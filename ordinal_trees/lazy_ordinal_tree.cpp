@@ -0,0 +1,126 @@
+#include "lazy_ordinal_tree.h"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+  // A small counter-based generator, cheap to start at every node
+  class SplitMix64 {
+    std::uint64_t state_;
+   public:
+    explicit SplitMix64(std::uint64_t state) : state_(state) {}
+    std::uint64_t operator()() {
+      auto z = (state_ += 0x9e3779b97f4a7c15ull);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+      return z ^ (z >> 31);
+    }
+    // uniform in (0, 1]
+    double next_double() {
+      return (static_cast<double>((*this)() >> 11) + 1) * 0x1.0p-53;
+    }
+  };
+
+  constexpr std::uint64_t kSmall = 64;
+
+  // log(C(j) / 4^j) for j < kSmall
+  const std::array<double, kSmall> &small_log_c() {
+    static const auto table = [] {
+      std::array<double, kSmall> t{};
+      double c = 1;
+      for (std::uint64_t j = 0; j < kSmall; ++j) {
+        if (j > 0) {
+          c *= (2.0*j - 1) / (2.0*(j + 1));
+        }
+        t[j] = std::log(c);
+      }
+      return t;
+    }();
+    return table;
+  }
+
+  // Stirling series of log Gamma beyond (z-1/2) log z - z + log(2 pi)/2
+  double stirling_tail(double z) {
+    const auto z2 = z*z;
+    return (1.0/12 - (1.0/360 - (1.0/1260 - 1.0/(1680*z2)) / z2) / z2) / z;
+  }
+
+  // log(C(j) / 4^j) = log(Gamma(j+1/2) / (sqrt(pi) Gamma(j+2))), written so that
+  // nothing of the order of j log j is ever subtracted
+  double log_c(std::uint64_t j) {
+    if (j < kSmall) {
+      return small_log_c()[j];
+    }
+    const auto x = static_cast<double>(j);
+    return x * std::log1p(-1.5 / (x + 2)) - 1.5 * std::log(x + 2) + 1.5
+           + stirling_tail(x + 0.5) - stirling_tail(x + 2) - 0.5 * std::log(M_PI);
+  }
+
+  // P(J = j) for J = floor(1/U^2) - 1, the proposal's k^(-3/2) tail
+  double tail_probability(std::uint64_t j) {
+    const auto a = std::sqrt(static_cast<double>(j) + 1), b = std::sqrt(static_cast<double>(j) + 2);
+    return 1 / (a * b * (a + b));
+  }
+
+  // sup_j C(j)/4^j / P(J = j), attained at j = 0
+  const double kTailBound = 1 / (1 - 1 / std::sqrt(2.0));
+
+  std::uint64_t mix(std::uint64_t seed, std::uint64_t id) {
+    return SplitMix64(seed ^ SplitMix64(id)())();
+  }
+
+  // Size of the first tree of a random forest of s nodes: rejection from a proposal
+  // with a k^(-3/2) tail at either end, accepted about one time in five
+  std::uint64_t first_tree_size(std::uint64_t s, SplitMix64 &rng) {
+    assert(s >= 1);
+    if (s == 1) {
+      return 1;
+    }
+    const auto bound = 0.5 * kTailBound * std::exp(log_c((s - 1) / 2) - log_c(s)) * (1 + 1e-9);
+    for (;;) {
+      const auto u = rng.next_double();
+      const auto x = 1 / (u * u);
+      if (x >= static_cast<double>(s) + 1) {
+        continue ;
+      }
+      const auto j = static_cast<std::uint64_t>(x) - 1;
+      const auto k = (rng() & 1) ? j + 1 : s - j;
+      const auto q = 0.5 * tail_probability(k - 1) + 0.5 * tail_probability(s - k);
+      if (rng.next_double() * bound * q <= LazyOrdinalTree::first_tree_probability(s, k)) {
+        return k;
+      }
+    }
+  }
+
+} // namespace
+
+LazyOrdinalTree::LazyOrdinalTree(std::uint64_t n, std::uint64_t seed) : n_(n), seed_(seed) {
+  assert(n >= 1);
+}
+
+std::uint64_t LazyOrdinalTree::size() const {
+  return n_;
+}
+
+LazyOrdinalTree::Node LazyOrdinalTree::root() const {
+  return {0, n_, 0};
+}
+
+double LazyOrdinalTree::first_tree_probability(std::uint64_t s, std::uint64_t k) {
+  assert(1 <= k and k <= s);
+  return std::exp(log_c(k - 1) + log_c(s - k) - log_c(s)) / 4;
+}
+
+std::vector<LazyOrdinalTree::Node> LazyOrdinalTree::children(const Node &x) const {
+  std::vector<Node> res;
+  SplitMix64 rng(mix(seed_, x.id));
+  auto next = x.id + 1;
+  for (auto rest = x.size - 1; rest > 0;) {
+    const auto k = first_tree_size(rest, rng);
+    res.push_back({next, k, x.depth + 1});
+    next += k, rest -= k;
+  }
+  return res;
+}
@@ -0,0 +1,35 @@
+#ifndef GENTREE_ORDINAL_TREES_LAZY_ORDINAL_TREE_H_
+#define GENTREE_ORDINAL_TREES_LAZY_ORDINAL_TREE_H_
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * A uniformly random ordinal tree with n nodes that is never materialized:
+ * the children of a node, with the sizes of their subtrees, are drawn when asked
+ * for, from randomness derived from the seed and the node's preorder rank alone.
+ * Expanding the same node twice gives the same answer, whatever was visited
+ * before, so time and memory scale with the nodes actually visited.
+ * The child forest of a node of size m is split into a first tree of k nodes and a
+ * forest of m-1-k with the exact conditional law C(k-1) C(m-1-k) / C(m-1).
+ */
+class LazyOrdinalTree {
+ public:
+  struct Node {
+    std::uint64_t id;     // preorder rank, the root being 0
+    std::uint64_t size;   // nodes in its subtree, itself included
+    std::uint64_t depth;
+  };
+ private:
+  std::uint64_t n_;
+  std::uint64_t seed_;
+ public:
+  LazyOrdinalTree(std::uint64_t n, std::uint64_t seed);
+  [[nodiscard]] std::uint64_t size() const;
+  [[nodiscard]] Node root() const;
+  [[nodiscard]] std::vector<Node> children(const Node& x) const;
+  // the probability that a forest of s nodes starts with a tree of k nodes
+  [[nodiscard]] static double first_tree_probability(std::uint64_t s, std::uint64_t k);
+};
+
+#endif //GENTREE_ORDINAL_TREES_LAZY_ORDINAL_TREE_H_
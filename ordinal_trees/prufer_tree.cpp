@@ -0,0 +1,230 @@
+#include "prufer_tree.h"
+
+#include "buffered_writer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+  // Blocks of 2^16 ids are drawn, counted and formatted as units of parallel work
+  constexpr unsigned kBlockBits = 16;
+  constexpr std::uint64_t kBlock = std::uint64_t{1} << kBlockBits;
+  // How far ahead the degrees about to be counted or decremented are prefetched
+  constexpr size_t kPrefetch = 32;
+
+  std::uint64_t hash64(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // Runs fn(lo, hi) over the blocks of [0, n), handing them out dynamically
+  template<typename Fn>
+  void parallel_blocks(std::uint64_t n, unsigned threads, Fn &&fn) {
+    const auto blocks = (n + kBlock - 1) >> kBlockBits;
+    std::atomic<std::uint64_t> next{0};
+    auto work = [&] {
+      for (std::uint64_t b; (b = next.fetch_add(1)) < blocks;) {
+        fn(b << kBlockBits, std::min(n, (b + 1) << kBlockBits));
+      }
+    };
+    threads = std::max(1u, static_cast<unsigned>(std::min<std::uint64_t>(threads, blocks)));
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+      workers.emplace_back(work);
+    }
+    work();
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
+  // A uniform draw from [0, n), by Lemire's multiply-and-reject
+  std::uint32_t uniform_below(std::mt19937_64 &rng, std::uint64_t n) {
+    auto m = static_cast<unsigned __int128>(rng()) * n;
+    if (static_cast<std::uint64_t>(m) < n) {
+      const auto threshold = (0 - n) % n;
+      while (static_cast<std::uint64_t>(m) < threshold) {
+        m = static_cast<unsigned __int128>(rng()) * n;
+      }
+    }
+    return static_cast<std::uint32_t>(m >> 64);
+  }
+
+  char *put_uint(char *p, std::uint64_t v) {
+    char digits[20];
+    int k = 0;
+    do {
+      digits[k++] = static_cast<char>('0' + v % 10);
+    } while (v /= 10);
+    for (; k > 0; *p++ = digits[--k]) ;
+    return p;
+  }
+
+  // The edges of the children in [lo, hi) into "out", as written by write_parent_tree
+  template<typename Id>
+  size_t format_binary(const std::vector<std::uint32_t> &parents, std::uint64_t lo, std::uint64_t hi,
+                       std::uint64_t dx, char *out) {
+    auto *ids = reinterpret_cast<Id*>(out);
+    for (auto c = lo; c < hi; ++c) {
+      if (parents[c] != c) {
+        *ids++ = static_cast<Id>(parents[c] + dx), *ids++ = static_cast<Id>(c + dx);
+      }
+    }
+    return reinterpret_cast<char*>(ids) - out;
+  }
+
+  size_t format_text(const std::vector<std::uint32_t> &parents, std::uint64_t lo, std::uint64_t hi,
+                     std::uint64_t dx, char *out) {
+    auto *p = out;
+    for (auto c = lo; c < hi; ++c) {
+      if (parents[c] != c) {
+        p = put_uint(p, parents[c] + dx), *p++ = ' ';
+        p = put_uint(p, c + dx), *p++ = '\n';
+      }
+    }
+    return p - out;
+  }
+
+} // namespace
+
+std::vector<std::uint32_t> random_prufer_sequence(std::uint64_t n, std::uint64_t seed, unsigned threads) {
+  if (n < 2 or n > kMaxPruferNodes) {
+    throw std::invalid_argument("a Prüfer sequence needs 2 to 2^32-1 nodes");
+  }
+  std::vector<std::uint32_t> code(n - 2);
+  const auto salt = hash64(seed);
+  parallel_blocks(code.size(), threads, [&](std::uint64_t lo, std::uint64_t hi) {
+    std::mt19937_64 rng(hash64(salt + (lo >> kBlockBits) + 1));
+    for (auto i = lo; i < hi; ++i) {
+      code[i] = uniform_below(rng, n);
+    }
+  });
+  return code;
+}
+
+std::vector<std::uint32_t> prufer_parents(const std::vector<std::uint32_t> &code, unsigned threads) {
+  const std::uint64_t m = code.size(), n = m + 2;
+  if (n > kMaxPruferNodes) {
+    throw std::invalid_argument("a Prüfer sequence has at most 2^32-3 ids");
+  }
+  // deg[x] is the degree of x while x is in the tree, and its parent once it is removed
+  std::vector<std::uint32_t> deg(n);
+  auto *d = deg.data();
+  std::atomic<bool> bad{false};
+  parallel_blocks(n, threads, [&](std::uint64_t lo, std::uint64_t hi) {
+    std::fill(d + lo, d + hi, 1u);
+  });
+  parallel_blocks(m, threads, [&](std::uint64_t lo, std::uint64_t hi) {
+    for (auto i = lo; i < hi; ++i) {
+      const auto v = code[i];
+      if (v >= n) {
+        bad = true;
+        return ;
+      }
+      if (i + kPrefetch < hi) {
+        __builtin_prefetch(d + code[i + kPrefetch], 1);
+      }
+      if (threads > 1) {
+        __atomic_fetch_add(d + v, 1u, __ATOMIC_RELAXED);
+      } else {
+        ++d[v];
+      }
+    }
+  });
+  if (bad) {
+    throw std::invalid_argument("Prüfer sequence ids must be below " + std::to_string(n));
+  }
+
+  std::uint64_t ptr = 0;
+  while (d[ptr] != 1) {
+    ++ptr;
+  }
+  std::uint64_t leaf = ptr;
+  for (std::uint64_t i = 0; i < m; ++i) {
+    if (i + kPrefetch < m) {
+      __builtin_prefetch(d + code[i + kPrefetch]);
+    }
+    const auto v = code[i];
+    d[leaf] = v;
+    if (--d[v] == 1 and v < ptr) {
+      leaf = v;
+    } else {
+      while (d[++ptr] != 1) ;
+      leaf = ptr;
+    }
+  }
+  d[leaf] = n - 1, d[n - 1] = n - 1;
+  return deg;
+}
+
+std::vector<std::uint32_t> random_free_tree(std::uint64_t n, std::uint64_t seed, unsigned threads) {
+  if (n == 1) {
+    return {0};
+  }
+  return prufer_parents(random_prufer_sequence(n, seed, threads), threads);
+}
+
+void write_parent_tree(std::ostream &os, const std::vector<std::uint32_t> &parents, TreeFormat format,
+                       const std::vector<std::int64_t> *weights, std::uint64_t dx, unsigned threads) {
+  if (format == TreeFormat::kBP) {
+    throw std::invalid_argument("a parent array is written as text or binary");
+  }
+  const std::uint64_t n = parents.size();
+  const bool has_weights = weights and not weights->empty();
+  const bool binary = format == TreeFormat::kBinary;
+  const std::uint32_t id_bytes = n + dx <= std::numeric_limits<std::uint32_t>::max() ? 4 : 8;
+  {
+    BufferedWriter out(os);
+    if (binary) {
+      BinaryTreeHeader header{};
+      std::memcpy(header.magic, kBinaryTreeMagic, sizeof header.magic);
+      header.id_bytes = id_bytes;
+      header.n = n, header.dx = dx, header.has_weights = has_weights;
+      out.write_raw(header);
+      if (has_weights) {
+        out.write(reinterpret_cast<const char*>(weights->data()), n * sizeof(std::int64_t));
+      }
+    } else {
+      out.write_uint(n), out.put('\n');
+      if (has_weights) {
+        int wid = 0;
+        for (auto x : *weights) {
+          out.write_int(x), out.put(' ');
+          if (++wid >= 80) {
+            wid = 0;
+            out.put('\n');
+          }
+        }
+        out.put('\n');
+      }
+    }
+  }
+
+  // Rounds of a few blocks per thread, formatted in parallel and then written in order
+  const size_t edge_bytes = binary ? 2 * id_bytes : 2 * 20 + 2;
+  threads = std::max(1u, threads);
+  const std::uint64_t round = std::uint64_t{4} * threads << kBlockBits;
+  std::vector<std::vector<char>> buffers(4 * threads, std::vector<char>(kBlock * edge_bytes));
+  std::vector<size_t> lengths(buffers.size());
+  for (std::uint64_t start = 0; start < n; start += round) {
+    const auto end = std::min(n, start + round);
+    parallel_blocks(end - start, threads, [&](std::uint64_t lo, std::uint64_t hi) {
+      auto *out = buffers[lo >> kBlockBits].data();
+      lengths[lo >> kBlockBits] = not binary ? format_text(parents, start + lo, start + hi, dx, out)
+          : id_bytes == 4 ? format_binary<std::uint32_t>(parents, start + lo, start + hi, dx, out)
+          : format_binary<std::uint64_t>(parents, start + lo, start + hi, dx, out);
+    });
+    for (size_t b = 0; b < buffers.size() and start + (b << kBlockBits) < end; ++b) {
+      os.write(buffers[b].data(), static_cast<std::streamsize>(lengths[b]));
+    }
+  }
+}
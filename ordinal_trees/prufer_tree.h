@@ -0,0 +1,40 @@
+#ifndef GENTREE_ORDINAL_TREES_PRUFER_TREE_H_
+#define GENTREE_ORDINAL_TREES_PRUFER_TREE_H_
+
+#include "tree_format.h"
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// The largest tree whose ids all fit in 32 bits
+constexpr std::uint64_t kMaxPruferNodes = 0xffffffffull;
+
+// A uniformly random Prüfer sequence of a labeled tree on 2 <= n <= kMaxPruferNodes nodes: n-2 ids
+// drawn uniformly from [0, n). Blocks of it are drawn in parallel, each from its own seed, so the
+// result depends on the seed only, not on the number of threads.
+std::vector<std::uint32_t> random_prufer_sequence(std::uint64_t n, std::uint64_t seed, unsigned threads= 1);
+
+/**
+ * Decodes the Prüfer sequence "code" of a labeled tree on n = code.size() + 2 nodes in O(n),
+ * by the pointer scan: the next leaf is either the node just made a leaf, when it is below the
+ * pointer, or the next node of degree one past the pointer. Degrees are counted in parallel into
+ * one flat array, which is then turned into the parent array in place: a removed leaf never has
+ * its degree read again, so its slot takes its parent.
+ * Returns the parent of every node, the tree being rooted at n-1 (whose own entry is n-1).
+ * Throws std::invalid_argument on ids >= n.
+ */
+std::vector<std::uint32_t> prufer_parents(const std::vector<std::uint32_t> &code, unsigned threads= 1);
+
+// A uniformly random labeled free tree on 1 <= n <= kMaxPruferNodes nodes, as prufer_parents
+// returns it; throws std::invalid_argument for other n
+std::vector<std::uint32_t> random_free_tree(std::uint64_t n, std::uint64_t seed, unsigned threads= 1);
+
+// Writes the tree of "parents" (the root being its own parent) as kText or kBinary, one
+// (parent, child) edge per child in increasing child order, ids shifted by "dx".
+// Blocks of edges are formatted in parallel and written in order.
+void write_parent_tree(std::ostream &os, const std::vector<std::uint32_t> &parents, TreeFormat format,
+                       const std::vector<std::int64_t> *weights= nullptr, std::uint64_t dx= 0,
+                       unsigned threads= 1);
+
+#endif //GENTREE_ORDINAL_TREES_PRUFER_TREE_H_
@@ -2,15 +2,21 @@
 
 #include "rand_bracket_seq.h"
 
-#include <sstream>
+RandOrdinalTreeFromBinary::RandOrdinalTreeFromBinary(size_t n) : bits_(n) {
+  RandomBrackSeqImpl(n).generate_to(bits_);
+}
 
-RandOrdinalTreeFromBinary::RandOrdinalTreeFromBinary(size_t n) {
-  bin_tree_ = std::make_unique<RandomBrackSeqImpl>(n);
-  std::ostringstream os;
-  bin_tree_->generate(os);
-  g_ = std::make_unique<Graph>(os.str());
+RandOrdinalTreeFromBinary::RandOrdinalTreeFromBinary(size_t n, std::uint64_t seed) : bits_(n) {
+  RandomBrackSeqImpl(n, seed).generate_to(bits_);
 }
 
 void RandOrdinalTreeFromBinary::generate(std::ostream &os) {
-  g_->serialize(os);
-}
\ No newline at end of file
+  TextSink sink(os);
+  generate_to(sink);
+}
+
+std::vector<std::uint32_t> RandOrdinalTreeFromBinary::parents() const {
+  ParentArraySink sink(bits_.size() / 2);
+  generate_to(sink);
+  return sink.release();
+}
@@ -2,21 +2,24 @@
 #define GENTREE_ORDINAL_TREES_RAND_ORDINAL_TREE_FROM_BPS_H_
 
 #include "rand_ordinal_tree_iface.h"
-#include "rand_bracket_seq_iface.h"
-#include "Graph.h"
+#include "bp_sink.h"
 
-#include <istream>
-#include <memory>
+#include <cstdint>
 #include <ostream>
-#include <string>
+#include <vector>
 
+// A uniformly random ordinal tree, kept as its balanced parentheses sequence at two bits per node
 class RandOrdinalTreeFromBinary : public IRandomOrdinalTree {
  private:
-  std::unique_ptr<Graph> g_;
-  std::unique_ptr<IRandomBrackSeq> bin_tree_;
+  BpBitSink bits_;
  public:
   explicit RandOrdinalTreeFromBinary(size_t n);
+  RandOrdinalTreeFromBinary(size_t n, std::uint64_t seed);
+  // pushes the tree's parentheses to "sink" (bp_sink.h)
+  template<typename Sink>
+  void generate_to(Sink &sink) const { bits_.replay(sink); }
   void generate(std::ostream& os) override;
+  [[nodiscard]] std::vector<std::uint32_t> parents() const override;
 };
 
-#endif //GENTREE_ORDINAL_TREES_RAND_ORDINAL_TREE_FROM_BPS_H_
\ No newline at end of file
+#endif //GENTREE_ORDINAL_TREES_RAND_ORDINAL_TREE_FROM_BPS_H_
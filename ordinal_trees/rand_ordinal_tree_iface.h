@@ -1,12 +1,16 @@
 #ifndef GENTREE_ORDINAL_TREES_RAND_ORDINAL_TREE_IFACE_H_
 #define GENTREE_ORDINAL_TREES_RAND_ORDINAL_TREE_IFACE_H_
 
+#include <cstdint>
 #include <ostream>
+#include <vector>
 
 class IRandomOrdinalTree {
  public:
   virtual ~IRandomOrdinalTree() = default;
   virtual void generate(std::ostream& os) = 0;
+  // parent of every node in preorder; parents[0] is the root's and is 0
+  [[nodiscard]] virtual std::vector<std::uint32_t> parents() const = 0;
 };
 
 #endif //GENTREE_ORDINAL_TREES_RAND_ORDINAL_TREE_IFACE_H_
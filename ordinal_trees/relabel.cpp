@@ -0,0 +1,213 @@
+#include "relabel.h"
+
+#include "phase_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <random>
+#include <thread>
+
+namespace {
+
+  // Buckets of 2^16 ids (256KiB) stay in the L2 cache while they are being shuffled or sorted
+  constexpr unsigned kBucketBits = 16;
+
+  std::uint64_t hash64(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // Runs fn(lo, hi, t) over "threads" contiguous slices of [0, n)
+  template<typename Fn>
+  void parallel_slices(std::uint64_t n, unsigned threads, Fn &&fn) {
+    threads = std::max(1u, std::min<unsigned>(threads, std::max<std::uint64_t>(1, n >> kBucketBits)));
+    if (threads == 1) {
+      fn(std::uint64_t{0}, n, 0u);
+      return ;
+    }
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] { fn(n * t / threads, n * (t + 1) / threads, t); });
+    }
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
+  // Runs fn(b) for every bucket b, handing buckets out dynamically
+  template<typename Fn>
+  void parallel_buckets(size_t buckets, unsigned threads, Fn &&fn) {
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+      for (size_t b; (b = next.fetch_add(1)) < buckets;) {
+        fn(b);
+      }
+    };
+    threads = std::max(1u, std::min<unsigned>(threads, buckets));
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+      workers.emplace_back(work);
+    }
+    work();
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
+  // Stable scatter of value_of(i), i < n, into "out" by bucket_of(i); every thread
+  // counts its slice, then writes it at offsets that follow the earlier slices.
+  // Returns where every bucket starts (and, last, n).
+  template<typename T, typename BucketOf, typename ValueOf>
+  std::vector<std::uint64_t> scatter(std::uint64_t n, size_t buckets, unsigned threads,
+                                     std::vector<T> &out, BucketOf &&bucket_of, ValueOf &&value_of) {
+    threads = std::max(1u, std::min<unsigned>(threads, std::max<std::uint64_t>(1, n >> kBucketBits)));
+    std::vector<std::vector<std::uint64_t>> counts(threads, std::vector<std::uint64_t>(buckets, 0));
+    parallel_slices(n, threads, [&](std::uint64_t lo, std::uint64_t hi, unsigned t) {
+      auto &c = counts[t];
+      for (auto i = lo; i < hi; ++i) {
+        ++c[bucket_of(i)];
+      }
+    });
+    std::vector<std::uint64_t> starts(buckets + 1);
+    std::uint64_t acc = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+      starts[b] = acc;
+      for (unsigned t = 0; t < threads; ++t) {
+        const auto c = counts[t][b];
+        counts[t][b] = acc, acc += c;
+      }
+    }
+    starts[buckets] = acc;
+    out.resize(n);
+    parallel_slices(n, threads, [&](std::uint64_t lo, std::uint64_t hi, unsigned t) {
+      auto &offset = counts[t];
+      for (auto i = lo; i < hi; ++i) {
+        out[offset[bucket_of(i)]++] = value_of(i);
+      }
+    });
+    return starts;
+  }
+
+} // namespace
+
+std::optional<LabelOrder> parse_label_order(const std::string &name) {
+  if (name == "preorder") {
+    return LabelOrder::kPreorder;
+  }
+  if (name == "bfs") {
+    return LabelOrder::kBfs;
+  }
+  if (name == "postorder") {
+    return LabelOrder::kPostorder;
+  }
+  if (name == "random") {
+    return LabelOrder::kRandom;
+  }
+  return std::nullopt;
+}
+
+std::vector<std::uint32_t> random_permutation(std::uint64_t n, std::uint64_t seed, unsigned threads) {
+  const size_t buckets = (n >> kBucketBits) + 1;
+  std::vector<std::uint32_t> perm;
+  // The bucket of i is a hash of (seed, i), so both passes of scatter() agree
+  const auto salt = hash64(seed);
+  const auto starts = scatter(n, buckets, threads, perm,
+      [salt, buckets](std::uint64_t i) {
+        return static_cast<size_t>((static_cast<unsigned __int128>(hash64(salt ^ i)) * buckets) >> 64);
+      },
+      [](std::uint64_t i) { return static_cast<std::uint32_t>(i); });
+  parallel_buckets(buckets, threads, [&](size_t b) {
+    std::mt19937_64 rng(hash64(salt + b + 1));
+    std::shuffle(perm.begin() + starts[b], perm.begin() + starts[b+1], rng);
+  });
+  return perm;
+}
+
+std::vector<std::uint32_t> make_labels(const std::vector<std::uint32_t> &parents, LabelOrder order,
+                                       std::uint64_t seed, unsigned threads) {
+  const auto n = parents.size();
+  std::vector<std::uint32_t> labels(n);
+  switch (order) {
+    case LabelOrder::kPreorder:
+      for (std::uint32_t v = 0; v < n; ++v) {
+        labels[v] = v;
+      }
+      break ;
+    case LabelOrder::kBfs: {
+      // Within a level, BFS visits the nodes in preorder: a stable counting sort by depth
+      std::vector<std::uint32_t> depth(n, 0);
+      std::vector<std::uint32_t> offset(1, 0);
+      for (std::uint32_t v = 1; v < n; ++v) {
+        depth[v] = depth[parents[v]] + 1;
+        if (depth[v] >= offset.size()) {
+          offset.push_back(0);
+        }
+      }
+      std::vector<std::uint32_t> count(offset.size(), 0);
+      for (auto d : depth) {
+        ++count[d];
+      }
+      for (size_t d = 1; d < offset.size(); ++d) {
+        offset[d] = offset[d-1] + count[d-1];
+      }
+      for (std::uint32_t v = 0; v < n; ++v) {
+        labels[v] = offset[depth[v]]++;
+      }
+      break ;
+    }
+    case LabelOrder::kPostorder: {
+      // post(v) = pre(v) + size(v) - 1 - depth(v)
+      std::vector<std::uint32_t> size(n, 1), depth(n, 0);
+      for (auto v = n; v-- > 1;) {
+        size[parents[v]] += size[v];
+      }
+      for (std::uint32_t v = 1; v < n; ++v) {
+        depth[v] = depth[parents[v]] + 1;
+      }
+      for (std::uint32_t v = 0; v < n; ++v) {
+        labels[v] = v + size[v] - 1 - depth[v];
+      }
+      break ;
+    }
+    case LabelOrder::kRandom:
+      // the inverse of a uniform permutation is uniform, so it serves as labels directly
+      labels = random_permutation(n, seed, threads);
+      break ;
+  }
+  return labels;
+}
+
+std::vector<tree_edge> relabel_edges(const std::vector<std::uint32_t> &parents,
+                                     const std::vector<std::uint32_t> &labels, unsigned threads) {
+  ScopedPhase phase("relabel");
+  const auto n = parents.size();
+  if (n < 2) {
+    return {};
+  }
+  assert(labels.size() == n);
+  // Two stable passes: by the high bits of the new parent into cache-sized buckets,
+  // then a counting sort by the low bits within every bucket
+  const size_t buckets = ((n - 1) >> kBucketBits) + 1;
+  std::vector<tree_edge> staged;
+  const auto starts = scatter(n - 1, buckets, threads, staged,
+      [&](std::uint64_t i) { return static_cast<size_t>(labels[parents[i+1]] >> kBucketBits); },
+      [&](std::uint64_t i) { return tree_edge{labels[parents[i+1]], labels[i+1]}; });
+  std::vector<tree_edge> edges(n - 1);
+  parallel_buckets(buckets, threads, [&](size_t b) {
+    std::vector<std::uint32_t> offset((1u << kBucketBits) + 1, 0);
+    constexpr std::uint32_t kMask = (1u << kBucketBits) - 1;
+    for (auto i = starts[b]; i < starts[b+1]; ++i) {
+      ++offset[(staged[i].first & kMask) + 1];
+    }
+    for (size_t k = 1; k < offset.size(); ++k) {
+      offset[k] += offset[k-1];
+    }
+    for (auto i = starts[b]; i < starts[b+1]; ++i) {
+      edges[starts[b] + offset[staged[i].first & kMask]++] = staged[i];
+    }
+  });
+  return edges;
+}
@@ -0,0 +1,34 @@
+#ifndef GENTREE_ORDINAL_TREES_RELABEL_H_
+#define GENTREE_ORDINAL_TREES_RELABEL_H_
+
+#include "tree_loader.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+enum class LabelOrder {
+  kPreorder,
+  kBfs,
+  kPostorder,
+  kRandom
+};
+
+std::optional<LabelOrder> parse_label_order(const std::string &name);
+
+// A uniformly random permutation of 0..n-1: every element is scattered to one of
+// many cache-sized buckets, which are then shuffled independently, all in parallel.
+// The result depends on the seed only, not on the number of threads.
+std::vector<std::uint32_t> random_permutation(std::uint64_t n, std::uint64_t seed, unsigned threads= 1);
+
+// The new id of every node, given by "parents" in preorder (parents[0] is ignored)
+std::vector<std::uint32_t> make_labels(const std::vector<std::uint32_t> &parents, LabelOrder order,
+                                       std::uint64_t seed= 0, unsigned threads= 1);
+
+// The (new parent, new child) edges, grouped by new parent in increasing order,
+// the children of each node keeping their original order
+std::vector<tree_edge> relabel_edges(const std::vector<std::uint32_t> &parents,
+                                     const std::vector<std::uint32_t> &labels, unsigned threads= 1);
+
+#endif //GENTREE_ORDINAL_TREES_RELABEL_H_
@@ -0,0 +1,50 @@
+#include "tree_enumerator.h"
+
+#include <cassert>
+#include <stdexcept>
+
+OrdinalTreeEnumerator::OrdinalTreeEnumerator(size_t n) {
+  if (n == 0) {
+    throw std::invalid_argument("a tree has at least one node");
+  }
+  // starts from the path: (^n )^n
+  t_ = n - 1;
+  bps_ = std::string(n, '(') + std::string(n, ')');
+  x_ = y_ = t_;
+}
+
+bool OrdinalTreeEnumerator::next() {
+  if (t_ < 2 or x_ >= 2 * t_ - 1) {
+    return false;
+  }
+  bps_[x_] = ')';
+  bps_[y_] = '(';
+  ++x_, ++y_;
+  if (bps_[x_] == ')') {
+    if (x_ == 2 * y_ - 2) {
+      ++x_;
+    } else {
+      bps_[x_] = '(';
+      bps_[2] = ')';
+      x_ = 3, y_ = 2;
+    }
+  }
+  ++visited_;
+  return true;
+}
+
+void OrdinalTreeEnumerator::parents(std::vector<std::uint32_t> &out) const {
+  out.resize(t_ + 1);
+  out[0] = 0;
+  // the open nodes on the root path are kept in "out" itself: top is the last opened
+  std::uint32_t next = 1, top = 0;
+  for (size_t i = 1; i <= 2 * t_; ++i) {
+    if (bps_[i] == '(') {
+      out[next] = top;
+      top = next++;
+    } else {
+      top = out[top];
+    }
+  }
+  assert(next == t_ + 1 and top == 0);
+}
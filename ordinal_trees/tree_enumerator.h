@@ -0,0 +1,36 @@
+#ifndef GENTREE_ORDINAL_TREES_TREE_ENUMERATOR_H_
+#define GENTREE_ORDINAL_TREES_TREE_ENUMERATOR_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Walks all Catalan(n-1) ordinal trees with n nodes, in the cool-lex order of
+ * Ruskey and Williams ("Generating balanced parentheses and binary trees by prefix shifts"):
+ * every step is a prefix shift that rewrites at most three parentheses of one
+ * reusable buffer, in O(1) worst-case time.
+ *
+ *   OrdinalTreeEnumerator e(n);
+ *   do { use(e.bps()); } while (e.next());
+ */
+class OrdinalTreeEnumerator {
+ public:
+  explicit OrdinalTreeEnumerator(size_t n);
+  // the current tree, root parentheses included; updated in place by next()
+  [[nodiscard]] const std::string &bps() const { return bps_; }
+  // moves to the next tree; false (and no change) after the last one
+  bool next();
+  // the parent of every node of the current tree in preorder, into a reused buffer, in O(n)
+  void parents(std::vector<std::uint32_t> &out) const;
+  // trees visited so far, the current one included
+  [[nodiscard]] std::uint64_t rank() const { return visited_; }
+
+ private:
+  // the inner 2(n-1) parentheses are bps_[1..2t], so the paper's 1-based indices carry over
+  std::string bps_;
+  size_t t_, x_, y_;
+  std::uint64_t visited_ = 1;
+};
+
+#endif //GENTREE_ORDINAL_TREES_TREE_ENUMERATOR_H_
@@ -0,0 +1,107 @@
+#include "tree_fingerprint.h"
+
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+  std::uint64_t mix64(std::uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  // Packs the parentheses inside the root's, behind a leading 1 bit
+  std::uint64_t pack_ordinal(const std::string &bps) {
+    std::uint64_t key = 1;
+    for (size_t i = 1; i + 1 < bps.size(); ++i) {
+      key = (key << 1) | (bps[i] == '(');
+    }
+    return key;
+  }
+
+  std::uint64_t hash_ordinal(const std::string &bps) {
+    std::uint64_t h = 0x243f6a8885a308d3ull ^ bps.size();
+    std::uint64_t word = 0;
+    for (size_t i = 0; i < bps.size(); ++i) {
+      word = (word << 1) | (bps[i] == '(');
+      if ((i & 63) == 63) {
+        h = mix64(h ^ word) + 0x9e3779b97f4a7c15ull;
+        word = 0;
+      }
+    }
+    return mix64(h ^ word);
+  }
+
+  // A node hashes the sum of its children's (re-mixed) hashes, which ignores their order
+  std::uint64_t hash_unordered(const std::string &bps) {
+    std::vector<std::uint64_t> sums;
+    std::uint64_t root = 0;
+    for (auto ch : bps) {
+      if (ch == '(') {
+        sums.push_back(0);
+        continue ;
+      }
+      assert(not sums.empty());
+      const auto h = mix64(sums.back() + 0x9e3779b97f4a7c15ull);
+      sums.pop_back();
+      if (sums.empty()) {
+        root = h;
+      } else {
+        sums.back() += mix64(h ^ 0x452821e638d01377ull);
+      }
+    }
+    return root;
+  }
+
+} // namespace
+
+std::optional<TreeShape> parse_tree_shape(const std::string &name) {
+  if (name == "ordinal") {
+    return TreeShape::kOrdinal;
+  }
+  if (name == "unordered") {
+    return TreeShape::kUnordered;
+  }
+  return std::nullopt;
+}
+
+std::uint64_t tree_fingerprint(const std::string &bps, TreeShape shape) {
+  std::uint64_t key;
+  if (shape == TreeShape::kOrdinal) {
+    key = bps.size() <= 64 ? pack_ordinal(bps) : hash_ordinal(bps);
+  } else {
+    key = hash_unordered(bps);
+  }
+  // 0 marks the empty slots of FingerprintSet
+  return key ? key : 1;
+}
+
+FingerprintSet::FingerprintSet(size_t capacity) {
+  size_t slots = 16;
+  while (slots < 2 * capacity) {
+    slots <<= 1;
+  }
+  mask_ = slots - 1;
+  slots_ = std::make_unique<std::atomic<std::uint64_t>[]>(slots);
+  for (size_t i = 0; i < slots; ++i) {
+    slots_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+bool FingerprintSet::insert(std::uint64_t fingerprint) {
+  assert(fingerprint != 0);
+  // packed fingerprints are not uniform, so the probe starts from a mixed position
+  for (size_t i = mix64(fingerprint) & mask_, probes = 0; probes <= mask_; i = (i + 1) & mask_, ++probes) {
+    auto current = slots_[i].load(std::memory_order_relaxed);
+    if (current == 0 and slots_[i].compare_exchange_strong(current, fingerprint, std::memory_order_relaxed)) {
+      size_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    if (current == fingerprint) {
+      return false;
+    }
+  }
+  throw std::length_error("FingerprintSet is full");
+}
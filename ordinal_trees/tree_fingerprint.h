@@ -0,0 +1,45 @@
+#ifndef GENTREE_ORDINAL_TREES_TREE_FINGERPRINT_H_
+#define GENTREE_ORDINAL_TREES_TREE_FINGERPRINT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+/**
+ * Which trees count as the same shape:
+ *  kOrdinal   -- equal balanced parentheses sequences
+ *  kUnordered -- isomorphic as rooted trees, the order of the children ignored
+ */
+enum class TreeShape {
+  kOrdinal,
+  kUnordered
+};
+
+std::optional<TreeShape> parse_tree_shape(const std::string &name);
+
+/**
+ * A non-zero 64-bit fingerprint of the shape of the tree with balanced parentheses "bps",
+ * in O(n) time with an explicit stack. Ordinal trees of up to 32 nodes are packed
+ * exactly; other trees are hashed (AHU-style for unordered ones: every node hashes
+ * the multiset of its children's hashes), so distinct shapes collide with probability about 2^-64.
+ */
+std::uint64_t tree_fingerprint(const std::string &bps, TreeShape shape);
+
+// A lock-free set of fingerprints with a fixed capacity, shared by the threads of a batch
+class FingerprintSet {
+ public:
+  // room for "capacity" fingerprints
+  explicit FingerprintSet(size_t capacity);
+  // true if "fingerprint" was not in the set yet; throws std::length_error when full
+  bool insert(std::uint64_t fingerprint);
+  [[nodiscard]] size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+ private:
+  size_t mask_;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> slots_;
+  std::atomic<size_t> size_{0};
+};
+
+#endif //GENTREE_ORDINAL_TREES_TREE_FINGERPRINT_H_
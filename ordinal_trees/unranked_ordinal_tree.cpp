@@ -0,0 +1,59 @@
+#include "unranked_ordinal_tree.h"
+
+#include <memory>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+  // The table takes O(n^2) to fill, so batches of trees of one size share it
+  const BrackSeqRanker &ranker(size_t pairs) {
+    thread_local std::unique_ptr<BrackSeqRanker> cached;
+    if (not cached or cached->pairs() != pairs) {
+      cached = std::make_unique<BrackSeqRanker>(pairs);
+    }
+    return *cached;
+  }
+
+  size_t pairs_of(size_t n) {
+    if (n == 0) {
+      throw std::invalid_argument("a tree has at least one node");
+    }
+    return n - 1;
+  }
+
+} // namespace
+
+UnrankedOrdinalTree::UnrankedOrdinalTree(size_t n) {
+  std::random_device dev;
+  std::mt19937_64 rng((static_cast<std::uint64_t>(dev()) << 32) | dev());
+  init(n, ranker(pairs_of(n)).random_rank(rng));
+}
+
+UnrankedOrdinalTree::UnrankedOrdinalTree(size_t n, std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  init(n, ranker(pairs_of(n)).random_rank(rng));
+}
+
+UnrankedOrdinalTree UnrankedOrdinalTree::at(size_t n, BrackSeqRanker::rank_type rank) {
+  UnrankedOrdinalTree tree;
+  tree.init(n, rank);
+  return tree;
+}
+
+void UnrankedOrdinalTree::init(size_t n, BrackSeqRanker::rank_type rank) {
+  rank_ = rank;
+  ranker(pairs_of(n)).unrank(rank, bps_);
+  bps_.insert(bps_.begin(), '(');
+  bps_.push_back(')');
+}
+
+void UnrankedOrdinalTree::generate(std::ostream &os) {
+  os << bps_;
+}
+
+std::vector<std::uint32_t> UnrankedOrdinalTree::parents() const {
+  ParentArraySink sink(bps_.size() / 2);
+  generate_to(sink);
+  return sink.release();
+}
@@ -0,0 +1,45 @@
+#ifndef GENTREE_ORDINAL_TREES_UNRANKED_ORDINAL_TREE_H_
+#define GENTREE_ORDINAL_TREES_UNRANKED_ORDINAL_TREE_H_
+
+#include "rand_ordinal_tree_iface.h"
+#include "bracket_seq_ranker.h"
+#include "bp_sink.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * A uniformly random ordinal tree with n <= BrackSeqRanker::kMaxPairs + 1 nodes,
+ * drawn as a single random index in [0, Catalan(n-1)) and unranked; or the tree of a given index.
+ */
+class UnrankedOrdinalTree : public IRandomOrdinalTree {
+ private:
+  std::string bps_;
+  BrackSeqRanker::rank_type rank_ = 0;
+  UnrankedOrdinalTree() = default;
+  void init(size_t n, BrackSeqRanker::rank_type rank);
+ public:
+  explicit UnrankedOrdinalTree(size_t n);
+  UnrankedOrdinalTree(size_t n, std::uint64_t seed);
+  // the tree of index "rank"; throws std::out_of_range if there is none
+  static UnrankedOrdinalTree at(size_t n, BrackSeqRanker::rank_type rank);
+  // pushes the tree's parentheses to "sink" (bp_sink.h)
+  template<typename Sink>
+  void generate_to(Sink &sink) const {
+    for (auto ch : bps_) {
+      if (ch == '(') {
+        sink.open();
+      } else {
+        sink.close();
+      }
+    }
+  }
+  void generate(std::ostream& os) override;
+  [[nodiscard]] std::vector<std::uint32_t> parents() const override;
+  [[nodiscard]] BrackSeqRanker::rank_type rank() const { return rank_; }
+  [[nodiscard]] const std::string &sequence() const { return bps_; }
+};
+
+#endif //GENTREE_ORDINAL_TREES_UNRANKED_ORDINAL_TREE_H_
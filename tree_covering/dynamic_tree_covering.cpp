@@ -0,0 +1,331 @@
+#include "dynamic_tree_covering.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+DynamicTreeCovering::DynamicTreeCovering(const std::vector<std::uint32_t>& parents, size_t L)
+    : m_L(std::max<size_t>(L, 1)), m_maxNodes(2 * m_L), m_minNodes(std::max<size_t>(L / 2, 1)) {
+  if (parents.empty()) {
+    throw std::invalid_argument("a tree has at least one node");
+  }
+  m_alive.push_back(true);
+  m_parent.push_back(kNone);
+  m_depth.push_back(0);
+  m_children.emplace_back();
+  m_childPos.push_back(0);
+  m_comp.push_back(kNone);
+  m_edgePos.push_back(0);
+  m_rootedAt.emplace_back();
+  m_subtree.push_back(0);
+  m_top.push_back(kNone);
+  m_size = 1;
+  for (size_t v = 1; v < parents.size(); ++v) {
+    if (parents[v] >= v) {
+      throw std::invalid_argument("parents must be given in preorder");
+    }
+    attach(parents[v]);
+  }
+  rebuild();
+}
+
+std::uint32_t DynamicTreeCovering::newComponent(std::uint32_t root) {
+  std::uint32_t c;
+  if (not m_freeComponents.empty()) {
+    c = m_freeComponents.back();
+    m_freeComponents.pop_back();
+  } else {
+    c = static_cast<std::uint32_t>(m_components.size());
+    m_components.emplace_back();
+  }
+  m_components[c].edges.clear();
+  m_components[c].root = kNone;
+  setRoot(c, root);
+  return c;
+}
+
+void DynamicTreeCovering::setRoot(std::uint32_t c, std::uint32_t root) {
+  auto &comp = m_components[c];
+  if (comp.root == root) {
+    return ;
+  }
+  if (comp.root != kNone) {
+    auto &list = m_rootedAt[comp.root];
+    const auto last = list.back();
+    list[comp.rootPos] = last;
+    m_components[last].rootPos = comp.rootPos;
+    list.pop_back();
+  }
+  comp.root = root;
+  if (root != kNone) {
+    comp.rootPos = static_cast<std::uint32_t>(m_rootedAt[root].size());
+    m_rootedAt[root].push_back(c);
+  }
+}
+
+void DynamicTreeCovering::destroyComponent(std::uint32_t c) {
+  assert(m_components[c].edges.empty());
+  setRoot(c, kNone);
+  m_freeComponents.push_back(c);
+}
+
+void DynamicTreeCovering::addEdge(std::uint32_t c, std::uint32_t v) {
+  m_comp[v] = c;
+  m_edgePos[v] = static_cast<std::uint32_t>(m_components[c].edges.size());
+  m_components[c].edges.push_back(v);
+}
+
+void DynamicTreeCovering::removeEdge(std::uint32_t v) {
+  auto &edges = m_components[m_comp[v]].edges;
+  const auto last = edges.back();
+  edges[m_edgePos[v]] = last;
+  m_edgePos[last] = m_edgePos[v];
+  edges.pop_back();
+  m_comp[v] = kNone;
+}
+
+// Moves the edges of "from" into "into", which keeps its root
+void DynamicTreeCovering::absorb(std::uint32_t into, std::uint32_t from) {
+  for (auto v : m_components[from].edges) {
+    addEdge(into, v);
+  }
+  m_components[from].edges.clear();
+  destroyComponent(from);
+}
+
+std::uint32_t DynamicTreeCovering::attach(std::uint32_t parent) {
+  const auto v = static_cast<std::uint32_t>(m_alive.size());
+  m_alive.push_back(true);
+  m_parent.push_back(parent);
+  m_depth.push_back(m_depth[parent] + 1);
+  m_childPos.push_back(static_cast<std::uint32_t>(m_children[parent].size()));
+  m_children[parent].push_back(v);
+  m_children.emplace_back();
+  m_comp.push_back(kNone);
+  m_edgePos.push_back(0);
+  m_rootedAt.emplace_back();
+  m_subtree.push_back(0);
+  m_top.push_back(kNone);
+  ++m_size;
+  return v;
+}
+
+std::uint32_t DynamicTreeCovering::insertLeaf(std::uint32_t parent) {
+  if (not contains(parent)) {
+    throw std::invalid_argument("no node " + std::to_string(parent));
+  }
+  const auto v = attach(parent);
+  // The new edge joins the component through "parent"; below the root, any component rooted there will do
+  std::uint32_t c = m_comp[parent];
+  if (c == kNone) {
+    c = m_rootedAt[parent].empty() ? newComponent(parent) : m_rootedAt[parent].back();
+  }
+  addEdge(c, v);
+  if (nodesOf(c) > m_maxNodes) {
+    split(c);
+  }
+  if (componentCount() > maxComponents()) {
+    rebuild();
+  }
+  return v;
+}
+
+void DynamicTreeCovering::eraseLeaf(std::uint32_t leaf) {
+  if (not contains(leaf) or leaf == root() or not m_children[leaf].empty()) {
+    throw std::invalid_argument(std::to_string(leaf) + " is not a leaf");
+  }
+  const auto c = m_comp[leaf];
+  removeEdge(leaf);
+  auto &siblings = m_children[m_parent[leaf]];
+  const auto last = siblings.back();
+  siblings[m_childPos[leaf]] = last;
+  m_childPos[last] = m_childPos[leaf];
+  siblings.pop_back();
+  m_alive[leaf] = false;
+  m_parent[leaf] = kNone;
+  --m_size;
+
+  if (m_components[c].edges.empty()) {
+    destroyComponent(c);
+  } else if (nodesOf(c) < m_minNodes) {
+    mergeSmall(c);
+  }
+  if (componentCount() > maxComponents()) {
+    rebuild();
+  }
+}
+
+// Joins "c" to the component above its root, or to another one sharing its root, if the union fits
+void DynamicTreeCovering::mergeSmall(std::uint32_t c) {
+  const auto r = m_components[c].root;
+  auto fits = [&](std::uint32_t d) {
+    return d != kNone and d != c and nodesOf(c) + nodesOf(d) - 1 <= m_maxNodes;
+  };
+  const auto above = m_comp[r];
+  if (fits(above)) {
+    // the union hangs from the root of "above"
+    if (nodesOf(c) > nodesOf(above)) {
+      setRoot(c, m_components[above].root);
+      absorb(c, above);
+    } else {
+      absorb(above, c);
+    }
+    return ;
+  }
+  // a couple of siblings are enough to keep this O(L)
+  const auto &siblings = m_rootedAt[r];
+  for (auto d : {siblings.front(), siblings.back()}) {
+    if (fits(d)) {
+      if (nodesOf(c) > nodesOf(d)) {
+        absorb(c, d);
+      } else {
+        absorb(d, c);
+      }
+      return ;
+    }
+  }
+}
+
+// Cuts the lowest node x whose part of "c" exceeds half the bound: the children of x within "c"
+// are grouped into new components rooted at x, each of at most half the bound plus one node.
+void DynamicTreeCovering::split(std::uint32_t c) {
+  const auto r = m_components[c].root;
+  auto edges = m_components[c].edges;
+  std::sort(edges.begin(), edges.end(), [this](auto a, auto b) { return m_depth[a] > m_depth[b]; });
+  for (auto v : edges) {
+    m_subtree[v] = 1;
+  }
+  for (auto v : edges) {
+    if (m_parent[v] != r) {
+      m_subtree[m_parent[v]] += m_subtree[v];
+    }
+  }
+  const auto half = m_maxNodes / 2;
+  auto x = r;
+  for (auto v : edges) {
+    if (m_subtree[v] > half) {
+      x = v;
+      break ;
+    }
+  }
+  // group the children of x, then hand every edge below x to the group of its top edge
+  std::vector<std::uint32_t> groups;
+  size_t filled = half;
+  for (auto it = edges.rbegin(); it != edges.rend(); ++it) {
+    const auto v = *it;
+    if (m_parent[v] == x) {
+      if (filled + m_subtree[v] > half) {
+        groups.push_back(newComponent(x));
+        filled = 0;
+      }
+      filled += m_subtree[v];
+      m_top[v] = groups.back();
+    } else {
+      m_top[v] = m_parent[v] != r ? m_top[m_parent[v]] : kNone;
+    }
+  }
+  for (auto v : edges) {
+    if (m_top[v] != kNone and m_top[v] != c) {
+      const auto g = m_top[v];
+      removeEdge(v);
+      addEdge(g, v);
+    }
+  }
+  for (auto v : edges) {
+    m_subtree[v] = 0;
+    m_top[v] = kNone;
+  }
+  if (m_components[c].edges.empty()) {
+    destroyComponent(c);
+  }
+}
+
+// Covers the tree afresh, bottom-up: the edges into the children of every node x, each with what is
+// left over below that child, are packed in order, and a pack becomes a component rooted at x once it
+// holds L edges; what is left of the last pack goes up with the edge into x. Every component but the
+// root's last pack has at least L edges and fewer than 2L, so there are at most (n-1)/L + 1 of them.
+// The (postorder) packing leaves, in m_subtree, the edges going up with each node's parent edge and,
+// in m_top, the component of each node's parent edge, kNone when it goes up; O(n).
+void DynamicTreeCovering::rebuild() {
+  m_components.clear();
+  m_freeComponents.clear();
+  for (auto &list : m_rootedAt) {
+    list.clear();
+  }
+  std::vector<std::pair<std::uint32_t, size_t>> stack{{root(), 0}};
+  while (not stack.empty()) {
+    const auto [x, next] = stack.back();
+    const auto &children = m_children[x];
+    if (next < children.size()) {
+      ++stack.back().second;
+      stack.emplace_back(children[next], 0);
+      continue ;
+    }
+    stack.pop_back();
+    size_t pack = 0, first = 0;
+    for (size_t k = 0; k < children.size(); ++k) {
+      pack += m_subtree[children[k]] + 1;
+      if (pack >= m_L) {
+        const auto c = newComponent(x);
+        for (; first <= k; ++first) {
+          m_top[children[first]] = c;
+        }
+        pack = 0;
+      }
+    }
+    for (; first < children.size(); ++first) {
+      m_top[children[first]] = kNone;
+    }
+    m_subtree[x] = static_cast<std::uint32_t>(pack);
+  }
+  // Top-down, every edge joins its component: its own pack's, or the one of its parent's edge
+  const auto last = m_subtree[root()] > 0 ? newComponent(root()) : kNone;
+  std::vector<std::uint32_t> order{root()};
+  while (not order.empty()) {
+    const auto x = order.back();
+    order.pop_back();
+    for (auto v : m_children[x]) {
+      addEdge(m_top[v] != kNone ? m_top[v] : x == root() ? last : m_comp[x], v);
+      order.push_back(v);
+    }
+  }
+  for (std::uint32_t v = 0; v < m_alive.size(); ++v) {
+    m_subtree[v] = 0, m_top[v] = kNone;
+  }
+}
+
+std::vector<tree_edge> DynamicTreeCovering::edges() const {
+  std::vector<tree_edge> result;
+  result.reserve(m_size - 1);
+  for (std::uint32_t v = 1; v < m_alive.size(); ++v) {
+    if (m_alive[v]) {
+      result.emplace_back(m_parent[v], v);
+    }
+  }
+  return result;
+}
+
+std::vector<CoveringComponent> DynamicTreeCovering::components() const {
+  std::vector<CoveringComponent> result;
+  std::vector<bool> free(m_components.size(), false);
+  for (auto c : m_freeComponents) {
+    free[c] = true;
+  }
+  for (size_t c = 0; c < m_components.size(); ++c) {
+    if (free[c]) {
+      continue ;
+    }
+    CoveringComponent component;
+    component.root = m_components[c].root;
+    for (auto v : m_components[c].edges) {
+      component.edges.emplace_back(m_parent[v], v);
+    }
+    result.push_back(std::move(component));
+  }
+  if (result.empty()) {
+    // a lone root is a single-node component
+    result.push_back({root(), {}});
+  }
+  return result;
+}
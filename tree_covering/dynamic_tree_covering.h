@@ -0,0 +1,84 @@
+//
+// A covering kept up to date while leaves come and go: components are split when they
+// outgrow 2L nodes, and merged with a neighbour, when the union fits, as they drop below
+// L/2. Small components may remain, so the number of components is what is bounded:
+// when it exceeds maxComponents(), about 4n/L, the tree is covered afresh in O(n),
+// with at most (n-1)/L + 1 components; that takes Omega(n/L) updates to happen again.
+//
+
+#ifndef GENTREE_TREE_COVERING_DYNAMIC_TREE_COVERING_H_
+#define GENTREE_TREE_COVERING_DYNAMIC_TREE_COVERING_H_
+
+#include "tree_covering.h"
+
+#include <cstdint>
+#include <vector>
+
+class DynamicTreeCovering {
+ public:
+  static constexpr std::uint32_t kNone = static_cast<std::uint32_t>(-1);
+
+  // Covers the tree with "parents" in preorder (parents[0], the root's, is ignored), node ids
+  // staying those of the parent array
+  DynamicTreeCovering(const std::vector<std::uint32_t>& parents, size_t L);
+
+  // Adds a leaf under "parent" and returns its id; O(L log L) amortized.
+  // Throws std::invalid_argument if "parent" is not in the tree.
+  std::uint32_t insertLeaf(std::uint32_t parent);
+  // Removes "leaf"; throws std::invalid_argument if it is the root, an inner node or not in the tree
+  void eraseLeaf(std::uint32_t leaf);
+
+  [[nodiscard]] bool contains(std::uint32_t x) const { return x < m_alive.size() and m_alive[x]; }
+  [[nodiscard]] bool isLeaf(std::uint32_t x) const { return contains(x) and m_children[x].empty(); }
+  [[nodiscard]] std::uint32_t root() const { return 0; }
+  // nodes in the tree; ids go up to idBound() - 1, with gaps where leaves were erased
+  [[nodiscard]] size_t size() const { return m_size; }
+  [[nodiscard]] size_t idBound() const { return m_alive.size(); }
+  [[nodiscard]] size_t componentCount() const { return m_components.size() - m_freeComponents.size(); }
+  [[nodiscard]] size_t maxNodes() const { return m_maxNodes; }
+  // a bound on componentCount() that holds after every update
+  [[nodiscard]] size_t maxComponents() const { return 4 * m_size / m_L + 2; }
+
+  // (parent, child) for every edge of the current tree
+  [[nodiscard]] std::vector<tree_edge> edges() const;
+  [[nodiscard]] std::vector<CoveringComponent> components() const;
+
+ private:
+  struct Component {
+    std::uint32_t root = kNone;
+    // every edge is named by its child
+    std::vector<std::uint32_t> edges;
+    // index in m_rootedAt[root]
+    std::uint32_t rootPos = 0;
+  };
+
+  [[nodiscard]] size_t nodesOf(std::uint32_t c) const { return m_components[c].edges.size() + 1; }
+  // adds a leaf under "parent" to the tree only, leaving the components alone
+  std::uint32_t attach(std::uint32_t parent);
+  void rebuild();
+  std::uint32_t newComponent(std::uint32_t root);
+  void destroyComponent(std::uint32_t c);
+  void setRoot(std::uint32_t c, std::uint32_t root);
+  void addEdge(std::uint32_t c, std::uint32_t v);
+  void removeEdge(std::uint32_t v);
+  void absorb(std::uint32_t into, std::uint32_t from);
+  void split(std::uint32_t c);
+  void mergeSmall(std::uint32_t c);
+
+  size_t m_L, m_maxNodes, m_minNodes, m_size = 0;
+  std::vector<bool> m_alive;
+  std::vector<std::uint32_t> m_parent, m_depth;
+  std::vector<std::vector<std::uint32_t>> m_children;
+  // index of each node in its parent's m_children
+  std::vector<std::uint32_t> m_childPos;
+  // component holding the edge into each node, and the index of the edge there
+  std::vector<std::uint32_t> m_comp, m_edgePos;
+  std::vector<Component> m_components;
+  std::vector<std::uint32_t> m_freeComponents;
+  // components rooted at each node
+  std::vector<std::vector<std::uint32_t>> m_rootedAt;
+  // scratch for split(): nodes below, and the top edge, within the component being split
+  std::vector<std::uint32_t> m_subtree, m_top;
+};
+
+#endif //GENTREE_TREE_COVERING_DYNAMIC_TREE_COVERING_H_
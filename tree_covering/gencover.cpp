@@ -0,0 +1,145 @@
+//
+// Generates random ordinal trees and covers them in the same process:
+// the tree reaches the covering as a BP or parent array, never as text.
+//
+#include "tree_covering.h"
+#include "dynamic_tree_covering.h"
+
+#include "phase_stats.h"
+#include "rand_bracket_seq.h"
+#include "rand_ordinal_tree_from_bps.h"
+
+#include "gflags/gflags.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+DEFINE_uint64(n, 1ull, "n the tree size to generate");
+DEFINE_uint64(L, 1ull, "L tree covering parameter -- mini-tree component size");
+DEFINE_uint64(trials, 1ull, "number of trees to generate and cover");
+DEFINE_uint64(seed, 0ull, "seed of the first trial, trial i uses seed+i (0: random)");
+DEFINE_string(source, "bp", "what the generator hands over: bp or parents");
+DEFINE_bool(print, false, "print the components as treecover does instead of a CSV summary");
+DEFINE_uint64(updates, 0ull, "apply this many random leaf insertions/deletions to a dynamic covering, then check it against decompose");
+DEFINE_string(stats, "", "write per-phase timings and memory usage as JSON to this path");
+
+// Applies random leaf updates to a DynamicTreeCovering of the tree and checks it; decompose covers
+// the final tree as well, and must pass the same check (except for the size bound and the edges it leaves out)
+void run_updates(std::ostream& os, std::uint64_t trial, std::uint64_t seed) {
+  RandOrdinalTreeFromBinary tree(FLAGS_n, seed);
+  DynamicTreeCovering dynamic(tree.parents(), FLAGS_L);
+  std::mt19937_64 rng(seed);
+  // the live nodes, to draw from
+  std::vector<std::uint32_t> live(FLAGS_n), pos(FLAGS_n);
+  for (std::uint32_t v = 0; v < FLAGS_n; ++v) {
+    live[v] = pos[v] = v;
+  }
+  const auto t0 = std::chrono::steady_clock::now();
+  for (std::uint64_t u = 0; u < FLAGS_updates; ++u) {
+    const auto x = live[std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng)];
+    if (rng() & 1 or not dynamic.isLeaf(x) or x == dynamic.root()) {
+      const auto v = dynamic.insertLeaf(x);
+      pos.push_back(static_cast<std::uint32_t>(live.size()));
+      live.push_back(v);
+    } else {
+      dynamic.eraseLeaf(x);
+      live[pos[x]] = live.back();
+      pos[live.back()] = pos[x];
+      live.pop_back();
+    }
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+
+  const auto edges = dynamic.edges();
+  const auto components = dynamic.components();
+  auto verdict = checkCovering(edges, components, dynamic.maxNodes(), true, dynamic.maxComponents());
+  size_t largest = 0;
+  for (const auto& c : components) {
+    largest = std::max(largest, c.edges.size() + 1);
+  }
+  // decompose needs the ids 0..n-1, with the root (0) first
+  std::vector<std::uint32_t> dense(dynamic.idBound(), 0);
+  std::uint32_t next = 1;
+  for (const auto& [x, y] : edges) {
+    dense[y] = next++;
+  }
+  std::vector<tree_edge> renamed;
+  for (const auto& [x, y] : edges) {
+    renamed.emplace_back(dense[x], dense[y]);
+  }
+  const auto reference = createTreeCovering(dynamic.size(), renamed)->cover(FLAGS_L);
+  if (verdict.empty()) {
+    verdict = checkCovering(renamed, reference, 0, false);
+  }
+  os << trial << ',' << seed << ',' << dynamic.size() << ',' << FLAGS_L << ',' << FLAGS_updates << ','
+     << components.size() << ',' << reference.size() << ',' << largest << ','
+     << std::chrono::duration<double>(t1 - t0).count() << ','
+     << (verdict.empty() ? "ok" : verdict) << '\n';
+}
+
+int main(int argc, char **argv) {
+  gflags::SetUsageMessage("Usage: gencover -n <num of nodes> -L <component size> -trials <count> -seed <seed> -source <bp|parents>");
+  gflags::ParseCommandLineFlags(&argc,&argv,true);
+  if (FLAGS_source != "bp" and FLAGS_source != "parents") {
+    std::cerr << "unknown source " << FLAGS_source << std::endl;
+    return 1;
+  }
+  if (FLAGS_n < 2) {
+    std::cerr << "n must be at least 2" << std::endl;
+    return 1;
+  }
+  if (not FLAGS_stats.empty()) {
+    PhaseStats::instance().enable("gencover");
+  }
+  const auto base_seed = FLAGS_seed ? FLAGS_seed : std::random_device{}();
+
+  std::ostream& os = std::cout;
+  if (FLAGS_updates > 0) {
+    os << "trial,seed,n,L,updates,components,decompose_components,max_component_nodes,update_seconds,check\n";
+    for (std::uint64_t trial = 0; trial < FLAGS_trials; ++trial) {
+      run_updates(os, trial, base_seed + trial);
+    }
+  } else {
+    if (not FLAGS_print) {
+      os << "trial,seed,n,L,components,max_component_edges,generate_seconds,cover_seconds\n";
+    }
+    for (std::uint64_t trial = 0; trial < FLAGS_trials; ++trial) {
+      const auto seed = base_seed + trial;
+      const auto t0 = std::chrono::steady_clock::now();
+      std::shared_ptr<ITreeCovering> covering;
+      if (FLAGS_source == "bp") {
+        RandomBrackSeqImpl seq(FLAGS_n, seed);
+        covering = createTreeCoveringFromBP(seq.sequence());
+      } else {
+        RandOrdinalTreeFromBinary tree(FLAGS_n, seed);
+        covering = createTreeCoveringFromParents(tree.parents());
+      }
+      const auto t1 = std::chrono::steady_clock::now();
+      if (FLAGS_print) {
+        covering->print(os, FLAGS_L);
+        continue ;
+      }
+      const auto components = covering->cover(FLAGS_L);
+      const auto t2 = std::chrono::steady_clock::now();
+      size_t largest = 0;
+      for (const auto& c : components) {
+        largest = std::max(largest, c.edges.size());
+      }
+      os << trial << ',' << seed << ',' << FLAGS_n << ',' << FLAGS_L << ','
+         << components.size() << ',' << largest << ','
+         << std::chrono::duration<double>(t1 - t0).count() << ','
+         << std::chrono::duration<double>(t2 - t1).count() << '\n';
+    }
+  }
+  os.flush();
+
+  if (not FLAGS_stats.empty() and not PhaseStats::instance().write_json(FLAGS_stats)) {
+    std::cerr << "cannot write stats to " << FLAGS_stats << std::endl;
+    return 1;
+  }
+  return 0;
+}
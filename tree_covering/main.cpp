@@ -2,19 +2,93 @@
 //
 #include "tree_covering.h"
 
+#include "phase_stats.h"
+#include "tree_loader.h"
+
 #include "gflags/gflags.h"
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// One JSON object for the whole sweep, one line per L
+void write_sweep(std::ostream& os, size_t n, double load_seconds, double build_seconds,
+                 const std::vector<CoveringSummary>& summaries) {
+  os << "{\n  \"n\": " << n << ",\n  \"load_seconds\": " << load_seconds
+     << ",\n  \"build_seconds\": " << build_seconds << ",\n  \"coverings\": [";
+  for (size_t i = 0; i < summaries.size(); ++i) {
+    const auto& s = summaries[i];
+    os << (i ? ",\n" : "\n") << "    {\"L\": " << s.L << ", \"components\": " << s.components
+       << ", \"seconds\": " << s.seconds << ", \"sizes\": [";
+    bool first = true;
+    for (size_t k = 0; k < s.sizes.size(); ++k) {
+      if (s.sizes[k] > 0) {
+        os << (first ? "" : ", ") << '[' << k << ", " << s.sizes[k] << ']';
+        first = false;
+      }
+    }
+    os << "]}";
+  }
+  os << "\n  ]\n}\n";
+}
 
 DEFINE_uint64(L, 1ull, "L tree covering parameter -- mini-tree component size");
+DEFINE_string(input, "", "tree to cover, in any otree format (default: standard input)");
+DEFINE_uint64(threads, 0ull, "threads used to parse text input and to run -sweep (0: one per core)");
+DEFINE_string(sweep, "", "comma-separated L values to cover the tree with, in parallel, reporting JSON summaries instead of the components");
+DEFINE_string(stats, "", "write per-phase timings and memory usage as JSON to this path");
 
 int main(int argc, char **argv) {
   gflags::ParseCommandLineFlags(&argc,&argv,true);
+  if (not FLAGS_stats.empty()) {
+    PhaseStats::instance().enable("treecover");
+  }
 
-  std::istream& is = std::cin;
-  auto ptr = createTreeCovering(is);
+  std::vector<size_t> Ls;
+  {
+    std::istringstream is(FLAGS_sweep);
+    for (std::string item; std::getline(is, item, ',');) {
+      try {
+        Ls.push_back(std::stoull(item));
+      } catch (const std::exception&) {
+        std::cerr << "bad L " << item << " in -sweep" << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  const auto threads = FLAGS_threads ? static_cast<unsigned>(FLAGS_threads)
+                                     : std::max(1u, std::thread::hardware_concurrency());
+  std::shared_ptr<ITreeCovering> ptr;
+  size_t n = 0;
+  double load_seconds = 0, build_seconds = 0;
+  try {
+    const auto start = std::chrono::steady_clock::now();
+    const auto tree = load_tree(FLAGS_input, threads);
+    const auto loaded = std::chrono::steady_clock::now();
+    ptr = createTreeCovering(tree.n, tree.edges);
+    n = tree.n;
+    load_seconds = std::chrono::duration<double>(loaded - start).count();
+    build_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loaded).count();
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
 
   std::ostream& os = std::cout;
-  ptr->print(os, FLAGS_L);
+  if (Ls.empty()) {
+    ptr->print(os, FLAGS_L);
+  } else {
+    write_sweep(os, n, load_seconds, build_seconds, ptr->sweep(Ls, threads));
+  }
+
+  if (not FLAGS_stats.empty() and not PhaseStats::instance().write_json(FLAGS_stats)) {
+    std::cerr << "cannot write stats to " << FLAGS_stats << std::endl;
+    return 1;
+  }
   return 0;
 }
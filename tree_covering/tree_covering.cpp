@@ -2,11 +2,17 @@
 //
 #include "tree_covering.h"
 
+#include "phase_stats.h"
+
 #include <algorithm>
-#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <iterator>
 #include <map>
 #include <set>
+#include <string>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -15,8 +21,6 @@ using node_type = int;
 using size_type = int;
 using arc_t = std::pair<int,int>;
 
-#define N (100'000)
-
 namespace {
 
   enum class Type {
@@ -52,42 +56,68 @@ namespace {
     }
   };
 
+  // The input is a tree, so arcs are distinct: the k-th edge yields
+  // arcs 2k (forward) and 2k+1 (backward)
   class ArcManager {
-    std::map<arc_t, size_type> m_arc_id;
-    std::map<size_type, arc_t> m_rev_map;
+    std::vector<arc_t> m_arcs;
    public:
+    void reserve(size_t m) {
+      m_arcs.reserve(m);
+    }
     size_type add(arc_t arc) {
-      if (m_arc_id.count(arc)) {
-        return m_arc_id.at(arc);
-      }
-      auto k = m_arc_id.size();
-      m_rev_map[m_arc_id[arc] = k++] = arc;
-      return k-1;
+      m_arcs.push_back(arc);
+      return static_cast<size_type>(m_arcs.size()) - 1;
     }
     void clear() {
-      m_arc_id.clear();
+      m_arcs.clear();
     }
-    size_type lookup(const arc_t& arc) const {
-      if (not m_arc_id.count(arc)) {
-        return -1;
-      }
-      return m_arc_id.at(arc);
+    size_t size() const {
+      return m_arcs.size();
     }
     node_type destinationOf(size_type idx) const {
-      return m_rev_map.at(idx).second;
+      return m_arcs[idx].second;
     }
     node_type sourceOf(size_type idx) const {
-      return m_rev_map.at(idx).first;
+      return m_arcs[idx].first;
+    }
+  };
+
+  // Arcs leaving each node, stored contiguously in the order they were added
+  class Adjacency {
+    std::vector<size_type> m_offset;
+    std::vector<size_type> m_arcs;
+   public:
+    struct Range {
+      const size_type *first, *last;
+      const size_type *begin() const { return first; }
+      const size_type *end() const { return last; }
+    };
+    void build(size_t n, const ArcManager& manager) {
+      m_offset.assign(n + 2, 0);
+      for (size_t idx = 0; idx < manager.size(); ++idx) {
+        ++m_offset[manager.sourceOf(idx) + 2];
+      }
+      for (size_t x = 2; x < n + 2; ++x) {
+        m_offset[x] += m_offset[x-1];
+      }
+      m_arcs.resize(manager.size());
+      for (size_t idx = 0; idx < manager.size(); ++idx) {
+        m_arcs[m_offset[manager.sourceOf(idx) + 1]++] = idx;
+      }
+      m_offset.pop_back();
+    }
+    Range operator[](node_type x) const {
+      return {m_arcs.data() + m_offset[x], m_arcs.data() + m_offset[x+1]};
     }
   };
 
   class TreeCovering : public ITreeCovering {
     size_t n;
     ArcManager m_manager;
-    std::vector<size_type> m_adj[N];
-    std::array<size_type, N> m_card;
-    std::array<size_type, N> m_parent;
-    std::array<bool, N> m_seen;
+    Adjacency m_adj;
+    std::vector<size_type> m_card;
+    std::vector<size_type> m_parent;
+    std::vector<bool> m_seen;
 
     size_type calcCard(node_type x) {
       if (m_seen[x]) {
@@ -104,7 +134,7 @@ namespace {
       return m_card[x];
     }
 
-    std::vector<size_type> childrenOf(node_type x) {
+    std::vector<size_type> childrenOf(node_type x) const {
       std::vector<size_type> children;
       for (const auto pr : m_adj[x]) {
         const auto y = m_manager.destinationOf(pr);
@@ -124,9 +154,9 @@ namespace {
       return cmp;
     }
 
-    std::vector<Component> caseOne(const node_type src,
-                                   std::vector<std::pair<size_type, Component>> temporary,
-                                   const size_t L) {
+    static std::vector<Component> caseOne(const node_type src,
+                                          std::vector<std::pair<size_type, Component>> temporary,
+                                          const size_t L) {
 
       if (temporary.empty()) {
         return {singleton(src, Type::kTemporary)};
@@ -166,8 +196,8 @@ namespace {
     }
 
     // Each recursive call decomposes a tree rooted at a node
-    // and returns component subtrees
-    std::vector<Component> decompose(node_type src, const size_type L) {
+    // and returns component subtrees; only reads the tree, so calls for several L may run at once
+    std::vector<Component> decompose(node_type src, const size_type L) const {
       std::vector<Component> result;
 
       // Indices of arcs leading to children:
@@ -279,41 +309,106 @@ namespace {
       return result;
     }
 
+    // "for_each_edge" calls back with every (parent, child) edge
+    template<typename EdgeVisitor>
+    void build(EdgeVisitor&& for_each_edge) {
+      {
+        ScopedPhase phase("build");
+        m_manager.reserve(2*(n-1));
+        for_each_edge([this](node_type i, node_type j) {
+          m_manager.add({i,j});
+          m_manager.add({j,i});
+        });
+        assert(m_manager.size() == 2*(n-1));
+        m_adj.build(n, m_manager);
+      }
+      ScopedPhase phase("calcCard");
+      m_seen.assign(n, false);
+      m_parent.assign(n, -1);
+      m_card.assign(n, 0);
+      calcCard(0);
+    }
+
    public:
 
     ~TreeCovering() override = default;
 
-    explicit TreeCovering(std::istream& is) {
-      is >> n;
-      for(auto i = 0; i < n; ++i) {
-        m_adj[i].clear();
+    TreeCovering(size_t n, const std::vector<tree_edge>& edges) : n(n) {
+      assert(edges.size() + 1 == n);
+      build([&edges](auto&& add) {
+        for (const auto& [i, j] : edges) {
+          add(i, j);
+        }
+      });
+    }
+
+    explicit TreeCovering(const std::vector<std::uint32_t>& parents) : n(parents.size()) {
+      build([&parents](auto&& add) {
+        for (size_t v = 1; v < parents.size(); ++v) {
+          add(parents[v], v);
+        }
+      });
+    }
+
+    std::vector<CoveringComponent> cover(const size_t L) override {
+      std::vector<Component> components;
+      {
+        ScopedPhase phase("decompose");
+        components = decompose(0, L);
       }
-      for (int k = 0; k < n-1; ++k) {
-        node_type i, j;
-        is >> i >> j; // 1-based index
-        --i, --j;
-        auto idxF = m_manager.add({i,j});
-        auto idxB = m_manager.add({j,i});
-        m_adj[i].push_back(idxF);
-        m_adj[j].push_back(idxB);
+      std::vector<CoveringComponent> result(components.size());
+      for (size_t k = 0; k < components.size(); ++k) {
+        result[k].root = components[k].root;
+        result[k].edges.reserve(components[k].edge_idx.size());
+        for (auto idx : components[k].edge_idx) {
+          result[k].edges.emplace_back(m_manager.sourceOf(idx), m_manager.destinationOf(idx));
+        }
       }
-      std::fill(m_seen.begin(), m_seen.begin()+n, false);
-      std::fill(m_parent.begin(), m_parent.begin()+n, -1);
-      calcCard(0);
+      return result;
+    }
+
+    std::vector<CoveringSummary> sweep(const std::vector<size_t>& Ls, unsigned threads) override {
+      ScopedPhase phase("sweep");
+      std::vector<CoveringSummary> result(Ls.size());
+      std::atomic<size_t> next{0};
+      auto work = [&] {
+        for (size_t i; (i = next.fetch_add(1)) < Ls.size();) {
+          const auto start = std::chrono::steady_clock::now();
+          const auto components = decompose(0, Ls[i]);
+          auto &summary = result[i];
+          summary.L = Ls[i];
+          summary.components = components.size();
+          for (const auto &c : components) {
+            const auto nodes = c.size() + 1;
+            if (summary.sizes.size() <= nodes) {
+              summary.sizes.resize(nodes + 1, 0);
+            }
+            ++summary.sizes[nodes];
+          }
+          summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+      };
+      std::vector<std::thread> workers;
+      for (unsigned t = 0; t < std::max(1u, std::min<unsigned>(threads, Ls.size())); ++t) {
+        workers.emplace_back(work);
+      }
+      for (auto &w : workers) {
+        w.join();
+      }
+      return result;
     }
 
     void print(std::ostream& os, const size_t L) override {
-      const auto components = decompose(0, L);
+      const auto components = cover(L);
+      ScopedPhase phase("print");
       int component = 0;
       for (const auto &c : components) {
         os << "[Component No] " << ++component << '\n';
-        if (c.size() == 0) {
+        if (c.edges.empty()) {
           os << "Single-node cluster: " << 1 + (c.root) << '\n';
           continue;
         }
-        for (auto idx : c.edge_idx) {
-          const auto x = m_manager.sourceOf(idx);
-          const auto y = m_manager.destinationOf(idx);
+        for (const auto& [x, y] : c.edges) {
           os << (x+1) << "->" << (y+1) << '\n';
         }
       }
@@ -323,5 +418,85 @@ namespace {
 } // namespace
 
 std::shared_ptr<ITreeCovering> createTreeCovering(std::istream& is) {
-  return std::make_shared<TreeCovering>(is);
+  const std::string input{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+  const auto tree = load_tree(input.data(), input.size());
+  return createTreeCovering(tree.n, tree.edges);
+}
+
+std::shared_ptr<ITreeCovering> createTreeCovering(size_t n, const std::vector<tree_edge>& edges) {
+  return std::make_shared<TreeCovering>(n, edges);
+}
+
+std::shared_ptr<ITreeCovering> createTreeCoveringFromParents(const std::vector<std::uint32_t>& parents) {
+  return std::make_shared<TreeCovering>(parents);
+}
+
+std::shared_ptr<ITreeCovering> createTreeCoveringFromBP(const std::string& bps) {
+  std::vector<std::uint32_t> parents(bps.size() / 2), st;
+  std::uint32_t V = 0;
+  for (auto ch : bps) {
+    if (ch == '(') {
+      parents[V] = st.empty() ? 0 : st.back();
+      st.push_back(V++);
+    } else {
+      assert(not st.empty());
+      st.pop_back();
+    }
+  }
+  assert(st.empty() and V == parents.size());
+  return createTreeCoveringFromParents(parents);
+}
+
+std::string checkCovering(const std::vector<tree_edge>& edges, const std::vector<CoveringComponent>& components,
+                          size_t max_nodes, bool every_edge, size_t max_components) {
+  constexpr auto kNone = static_cast<std::uint32_t>(-1);
+  if (max_components > 0 and components.size() > max_components) {
+    return std::to_string(components.size()) + " components, more than " + std::to_string(max_components);
+  }
+  std::uint32_t bound = 0;
+  for (const auto& [x, y] : edges) {
+    bound = std::max({bound, x + 1, y + 1});
+  }
+  bound = std::max<std::uint32_t>(bound, 1);
+  std::vector<std::uint32_t> parent(bound, kNone), owner(bound, kNone);
+  std::vector<bool> covered(bound, false);
+  for (const auto& [x, y] : edges) {
+    parent[y] = x;
+  }
+  for (size_t k = 0; k < components.size(); ++k) {
+    const auto& c = components[k];
+    if (max_nodes > 0 and c.edges.size() + 1 > max_nodes) {
+      return "component " + std::to_string(k) + " has " + std::to_string(c.edges.size() + 1) + " nodes";
+    }
+    if (c.root >= bound) {
+      return "component " + std::to_string(k) + " has root " + std::to_string(c.root) + ", not a node";
+    }
+    covered[c.root] = true;
+    for (const auto& [x, y] : c.edges) {
+      if (y >= bound or parent[y] != x) {
+        return "component " + std::to_string(k) + " has " + std::to_string(x) + "->" + std::to_string(y) + ", not a tree edge";
+      }
+      if (owner[y] != kNone) {
+        return "edge " + std::to_string(x) + "->" + std::to_string(y) + " is in two components";
+      }
+      owner[y] = static_cast<std::uint32_t>(k), covered[y] = true;
+    }
+  }
+  for (size_t k = 0; k < components.size(); ++k) {
+    // the edges of a component reach up to its root without leaving it
+    for (const auto& [x, y] : components[k].edges) {
+      if (x != components[k].root and owner[x] != k) {
+        return "component " + std::to_string(k) + " is not connected to its root " + std::to_string(components[k].root);
+      }
+    }
+  }
+  for (const auto& [x, y] : edges) {
+    if (every_edge and owner[y] == kNone) {
+      return "edge " + std::to_string(x) + "->" + std::to_string(y) + " is in no component";
+    }
+    if (not covered[x] or not covered[y]) {
+      return "node " + std::to_string(covered[x] ? y : x) + " is in no component";
+    }
+  }
+  return "";
 }
@@ -7,14 +7,58 @@
 #ifndef GENTREE_TREE_COVERING_TREE_COVERING_H_
 #define GENTREE_TREE_COVERING_TREE_COVERING_H_
 
+#include "tree_loader.h"
+
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
+
+// A mini-tree of the covering; a component without edges is the single node "root"
+struct CoveringComponent {
+  std::uint32_t root;
+  // (parent, child), 0-based
+  std::vector<tree_edge> edges;
+};
+
+// The shape of the covering for one L
+struct CoveringSummary {
+  size_t L;
+  size_t components;
+  // sizes[k] components have k nodes
+  std::vector<std::uint64_t> sizes;
+  double seconds;
+};
 
 struct ITreeCovering {
   virtual ~ITreeCovering() = default;
+  virtual std::vector<CoveringComponent> cover(const size_t L) = 0;
   virtual void print(std::ostream& os, const size_t L) = 0;
+  // Covers the same tree for every L of "Ls", up to "threads" at a time; the tree,
+  // its arcs and subtree sizes are built once and shared read-only
+  virtual std::vector<CoveringSummary> sweep(const std::vector<size_t>& Ls, unsigned threads) = 0;
 };
 
+/**
+ * Checks that "components" cover the tree whose (parent, child) edges are "edges": every node lies in
+ * some component, no edge in two, every component is a subtree hanging from its root, and none has more
+ * than "max_nodes" nodes (0: no bound), nor are there more than "max_components" of them (0: no bound).
+ * With "every_edge", each edge must also lie in a component; decompose leaves out the edges to heavy
+ * children whose components were made permanent.
+ * Returns what is wrong, or an empty string.
+ */
+std::string checkCovering(const std::vector<tree_edge>& edges, const std::vector<CoveringComponent>& components,
+                          size_t max_nodes= 0, bool every_edge= true, size_t max_components= 0);
+
+// Reads a tree in any format otree writes, with 0- or 1-based ids
 std::shared_ptr<ITreeCovering> createTreeCovering(std::istream& is);
+// "edges" connect the 0-based ids 0..n-1; node 0 is the root
+std::shared_ptr<ITreeCovering> createTreeCovering(size_t n, const std::vector<tree_edge>& edges);
+// In-memory handoff from a generator, without going through text:
+// "parents[v]" is the parent of node v in a preorder numbering (parents[0], the root's, is ignored)
+std::shared_ptr<ITreeCovering> createTreeCoveringFromParents(const std::vector<std::uint32_t>& parents);
+// "bps" is the balanced parentheses sequence of the tree
+std::shared_ptr<ITreeCovering> createTreeCoveringFromBP(const std::string& bps);
 
 #endif //GENTREE_TREE_COVERING_TREE_COVERING_H_
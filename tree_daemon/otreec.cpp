@@ -0,0 +1,70 @@
+//
+// Fetches a tree from otreed, the way otree would write it
+//
+#include "unix_socket.h"
+
+#include "gflags/gflags.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+DEFINE_string(socket, "/tmp/otreed.sock", "path of otreed's socket");
+DEFINE_uint64(n, 1000ull, "number of nodes");
+DEFINE_uint64(seed, 0ull, "seed of the tree (0: any random tree, from a pool when one is warm)");
+DEFINE_string(format, "text", "output format: text, bp or binary");
+DEFINE_uint64(a, 1ull, "weights are drawn from [a,b] when a <= b");
+DEFINE_uint64(b, 0ull, "weights are drawn from [a,b] when a <= b");
+DEFINE_uint64(dx, 0ull, "shift of the node ids");
+DEFINE_string(output, "", "file to write the tree to (default: standard output)");
+DEFINE_uint64(repeat, 1ull, "requests to send, reporting their latency; only the last tree is written");
+
+int main(int argc, char **argv) {
+  gflags::SetUsageMessage("Usage: otreec -n <nodes> [-format bp] [-output <path>]");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  const auto line = "n=" + std::to_string(FLAGS_n) + " seed=" + std::to_string(FLAGS_seed)
+      + " format=" + FLAGS_format + " a=" + std::to_string(FLAGS_a) + " b=" + std::to_string(FLAGS_b)
+      + " dx=" + std::to_string(FLAGS_dx);
+  try {
+    TreeClient client(FLAGS_socket);
+    SealedTree tree;
+    std::vector<double> micros;
+    for (std::uint64_t i = 0; i < std::max<std::uint64_t>(FLAGS_repeat, 1); ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      tree = client.request(line);
+      const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+      micros.push_back(elapsed.count());
+    }
+    if (micros.size() > 1) {
+      std::sort(micros.begin(), micros.end());
+      std::cerr << micros.size() << " requests: median " << micros[micros.size() / 2] << "us, p99 "
+                << micros[micros.size() * 99 / 100] << "us, max " << micros.back() << "us" << std::endl;
+    }
+
+    int out = STDOUT_FILENO;
+    if (not FLAGS_output.empty()) {
+      out = ::open(FLAGS_output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+      if (out < 0) {
+        throw std::runtime_error("cannot open " + FLAGS_output + ": " + std::strerror(errno));
+      }
+    }
+    tree.send_to(out);
+    if (out != STDOUT_FILENO) {
+      ::close(out);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "otreec: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
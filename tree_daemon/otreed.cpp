@@ -0,0 +1,75 @@
+//
+// Serves random trees on a Unix-domain socket, keeping pools of them ready (see tree_service.h)
+//
+#include "tree_service.h"
+
+#include "gflags/gflags.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+DEFINE_string(socket, "/tmp/otreed.sock", "path of the Unix-domain socket to listen at");
+DEFINE_string(warm, "", "the requests kept in pools, filled at startup, separated by ';' (e.g. \"n=1000;n=100000 format=bp\")");
+DEFINE_uint64(pool_depth, 16ull, "trees kept ready per pool (0: no pools, every tree is generated on request)");
+DEFINE_uint64(max_pool_nodes, 1ull << 20, "trees with more nodes are generated on request, never pooled");
+DEFINE_uint64(threads, 0ull, "background threads refilling the pools (0: one per core)");
+
+namespace {
+
+  char socket_path[108];
+
+  extern "C" void on_signal(int) {
+    ::unlink(socket_path);
+    ::_exit(0);
+  }
+
+} // namespace
+
+int main(int argc, char **argv) {
+  gflags::SetUsageMessage("Usage: otreed -socket <path> [-warm \"n=1000;n=5000 format=bp\"]");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  const auto threads = FLAGS_threads ? static_cast<unsigned>(FLAGS_threads)
+                                     : std::max(1u, std::thread::hardware_concurrency());
+  try {
+    TreePool pool(FLAGS_pool_depth, FLAGS_max_pool_nodes, threads);
+    std::istringstream warm(FLAGS_warm);
+    for (std::string line; std::getline(warm, line, ';');) {
+      if (line.find_first_not_of(" \t") == std::string::npos) {
+        continue ;
+      }
+      if (not pool.warm(parse_tree_request(line))) {
+        std::cerr << "not pooled (seeded or more than " << FLAGS_max_pool_nodes << " nodes): " << line << std::endl;
+      }
+    }
+
+    const int listener = listen_unix(FLAGS_socket);
+    std::strncpy(socket_path, FLAGS_socket.c_str(), sizeof socket_path - 1);
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::cerr << "otreed listening at " << FLAGS_socket << std::endl;
+    for (;;) {
+      const int sock = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+      if (sock < 0) {
+        if (errno == EINTR or errno == ECONNABORTED) {
+          continue ;
+        }
+        throw std::runtime_error(std::string("cannot accept: ") + std::strerror(errno));
+      }
+      std::thread(serve_connection, sock, std::ref(pool)).detach();
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "otreed: " << e.what() << std::endl;
+    return 1;
+  }
+}
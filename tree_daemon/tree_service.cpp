@@ -0,0 +1,231 @@
+#include "tree_service.h"
+
+#include "ordinal_tree_io.h"
+#include "rand_bracket_seq.h"
+#include "rand_utils.h"
+
+#include <unistd.h>
+
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+  std::uint64_t parse_number(const std::string &key, const std::string &value) {
+    size_t used = 0;
+    std::uint64_t x = 0;
+    try {
+      x = std::stoull(value, &used);
+    } catch (const std::exception&) {
+      used = 0;
+    }
+    if (used == 0 or used != value.size() or value.front() == '-') {
+      throw std::invalid_argument("bad " + key + " " + value);
+    }
+    return x;
+  }
+
+} // namespace
+
+TreeRequest parse_tree_request(const std::string &line) {
+  TreeRequest request;
+  std::istringstream is(line);
+  for (std::string item; is >> item;) {
+    const auto eq = item.find('=');
+    if (eq == std::string::npos) {
+      throw std::invalid_argument("expected key=value, found " + item);
+    }
+    const auto key = item.substr(0, eq), value = item.substr(eq + 1);
+    if (key == "n") {
+      request.n = parse_number(key, value);
+    } else if (key == "seed") {
+      request.seed = parse_number(key, value);
+    } else if (key == "a") {
+      request.a = parse_number(key, value);
+    } else if (key == "b") {
+      request.b = parse_number(key, value);
+    } else if (key == "dx") {
+      request.dx = parse_number(key, value);
+    } else if (key == "format") {
+      const auto format = parse_tree_format(value);
+      if (not format) {
+        throw std::invalid_argument("unknown format " + value);
+      }
+      request.format = *format;
+    } else if (key == "handoff") {
+      if (value != "fd" and value != "stream") {
+        throw std::invalid_argument("unknown handoff " + value);
+      }
+      request.handoff = value == "fd" ? Handoff::kDescriptor : Handoff::kStream;
+    } else {
+      throw std::invalid_argument("unknown key " + key);
+    }
+  }
+  // the parentheses generator needs a pair inside the root's
+  if (request.n < 2 or request.n > std::numeric_limits<std::int32_t>::max()) {
+    throw std::invalid_argument("n must be in [2, 2^31)");
+  }
+  return request;
+}
+
+std::string serialize_tree(const TreeRequest &request) {
+  std::random_device dev;
+  std::string bps;
+  bps.reserve(2 * request.n);
+  StringSink sink(bps);
+  if (request.seed) {
+    RandomBrackSeqImpl(request.n, request.seed).generate_to(sink);
+  } else {
+    RandomBrackSeqImpl(request.n).generate_to(sink);
+  }
+  std::vector<std::int64_t> weights;
+  if (request.a <= request.b) {
+    const auto seed = request.seed ? request.seed * 0x9e3779b97f4a7c15ull + 1 : dev();
+    weights = rand_utils::rand_weights(request.n, request.a, request.b, seed);
+  }
+  std::ostringstream os;
+  if (request.format == TreeFormat::kBP) {
+    print_bp(os, bps, &weights);
+    return os.str();
+  }
+  random_ordinal_tree::ordinal_tree tree;
+  convert(bps, tree);
+  if (request.format == TreeFormat::kText) {
+    print(os, tree, weights.empty() ? std::nullopt : std::make_optional(weights), request.dx);
+  } else {
+    write_binary(os, tree, &weights, request.dx);
+  }
+  return os.str();
+}
+
+TreePool::TreePool(size_t depth, std::uint64_t max_nodes, unsigned threads)
+    : depth_(depth), max_nodes_(max_nodes) {
+  for (unsigned t = 0; t < threads and depth > 0; ++t) {
+    workers_.emplace_back([this] { refill(); });
+  }
+}
+
+TreePool::~TreePool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  hungry_.notify_all();
+  for (auto &w : workers_) {
+    w.join();
+  }
+}
+
+TreePool::Key TreePool::key_of(const TreeRequest &request) {
+  // all requests without weights share a pool
+  const bool weights = request.a <= request.b;
+  return {request.n, request.format, weights ? request.a : 1, weights ? request.b : 0, request.dx};
+}
+
+std::optional<TreePool::Key> TreePool::next_hungry() {
+  std::optional<Key> best;
+  size_t fill = depth_;
+  for (const auto &[key, pool] : pools_) {
+    if (pool.ready.size() + pool.pending < fill) {
+      fill = pool.ready.size() + pool.pending, best = key;
+    }
+  }
+  return best;
+}
+
+void TreePool::refill() {
+  for (;;) {
+    Key key;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      std::optional<Key> hungry;
+      hungry_.wait(lock, [&] {
+        return stop_ or (hungry = next_hungry()).has_value();
+      });
+      if (stop_) {
+        return ;
+      }
+      key = *hungry;
+      ++pools_[key].pending;
+    }
+    TreeRequest request;
+    std::tie(request.n, request.format, request.a, request.b, request.dx) = key;
+    std::optional<SealedTree> tree;
+    try {
+      tree = seal_tree(serialize_tree(request));
+    } catch (const std::exception &e) {
+      std::cerr << "otreed: " << e.what() << std::endl;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &pool = pools_[key];
+    --pool.pending;
+    if (tree) {
+      pool.ready.push_back(std::move(*tree));
+    } else if (pool.pending == 0) {
+      // dropped rather than retried forever
+      pools_.erase(key);
+    }
+  }
+}
+
+bool TreePool::warm(const TreeRequest &request) {
+  if (request.seed != 0 or request.n > max_nodes_ or depth_ == 0) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pools_[key_of(request)];
+  }
+  hungry_.notify_all();
+  return true;
+}
+
+SealedTree TreePool::take(const TreeRequest &request) {
+  if (request.seed == 0) {
+    // only warmed pools are looked up: one made per key asked for would grow without bound
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto it = pools_.find(key_of(request));
+    if (it != pools_.end() and not it->second.ready.empty()) {
+      auto &ready = it->second.ready;
+      auto tree = std::move(ready.front());
+      ready.pop_front();
+      lock.unlock();
+      hungry_.notify_one();
+      return tree;
+    }
+  }
+  return seal_tree(serialize_tree(request));
+}
+
+void serve_connection(int sock, TreePool &pool) {
+  std::string buffer, line;
+  try {
+    while (read_line(sock, buffer, line)) {
+      if (line.find_first_not_of(" \t\r") == std::string::npos) {
+        continue ;
+      }
+      TreeRequest request;
+      try {
+        request = parse_tree_request(line);
+      } catch (const std::invalid_argument &e) {
+        send_line(sock, std::string("ERR ") + e.what() + "\n");
+        continue ;
+      }
+      const auto tree = pool.take(request);
+      const auto reply = "OK " + std::to_string(tree.size()) + "\n";
+      if (request.handoff == Handoff::kDescriptor) {
+        send_line(sock, reply, tree.fd());
+      } else {
+        send_line(sock, reply);
+        tree.send_to(sock);
+      }
+    }
+  } catch (const std::exception &e) {
+    // the client is gone, or the tree could not be made: either way the connection ends
+    std::cerr << "otreed: " << e.what() << std::endl;
+  }
+  ::close(sock);
+}
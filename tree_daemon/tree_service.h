@@ -0,0 +1,85 @@
+#ifndef GENTREE_TREE_DAEMON_TREE_SERVICE_H_
+#define GENTREE_TREE_DAEMON_TREE_SERVICE_H_
+
+#include "tree_format.h"
+#include "unix_socket.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// How a tree reaches the client: as a descriptor passed on the socket, or as bytes after the reply line
+enum class Handoff {
+  kDescriptor,
+  kStream
+};
+
+/**
+ * One line of the protocol, "key=value" pairs in any order:
+ *   n=<nodes> [seed=<s>] [format=text|bp|binary] [a=<lo> b=<hi>] [dx=<0|1>] [handoff=fd|stream]
+ * Seed 0 (the default) asks for any random tree, and weights are drawn when a <= b, as in otree.
+ * The reply is "OK <bytes>" or "ERR <message>", on one line.
+ */
+struct TreeRequest {
+  std::uint64_t n = 0;
+  std::uint64_t seed = 0;
+  TreeFormat format = TreeFormat::kText;
+  std::uint64_t a = 1, b = 0;
+  std::uint64_t dx = 0;
+  Handoff handoff = Handoff::kDescriptor;
+};
+
+// Throws std::invalid_argument on unknown keys or bad values
+TreeRequest parse_tree_request(const std::string &line);
+
+// The tree of "request", byte for byte as otree writes it
+std::string serialize_tree(const TreeRequest &request);
+
+/**
+ * Trees for requests without a seed, kept ready in sealed memory files: every (n, format, weights, dx)
+ * warmed, up to "max_nodes" nodes, gets a pool that "threads" background threads keep "depth" deep.
+ * Other requests are generated when they come, so the pools stay the ones chosen at startup.
+ * Thread-safe.
+ */
+class TreePool {
+  using Key = std::tuple<std::uint64_t, TreeFormat, std::uint64_t, std::uint64_t, std::uint64_t>;
+  struct Pool {
+    std::deque<SealedTree> ready;
+    size_t pending = 0;
+  };
+  size_t depth_;
+  std::uint64_t max_nodes_;
+  std::mutex mutex_;
+  std::condition_variable hungry_;
+  std::map<Key, Pool> pools_;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+
+  static Key key_of(const TreeRequest &request);
+  // a pool to refill, if any; the caller holds the lock
+  std::optional<Key> next_hungry();
+  void refill();
+ public:
+  TreePool(size_t depth, std::uint64_t max_nodes, unsigned threads);
+  ~TreePool();
+  TreePool(const TreePool&) = delete;
+  TreePool& operator=(const TreePool&) = delete;
+
+  // Starts keeping trees like "request" ready; false if it has a seed or too many nodes
+  bool warm(const TreeRequest &request);
+  // A tree for "request": from its warmed pool when that has a tree ready, generated on the spot otherwise
+  SealedTree take(const TreeRequest &request);
+};
+
+// Answers the requests on "sock" until the client hangs up, then closes it
+void serve_connection(int sock, TreePool &pool);
+
+#endif //GENTREE_TREE_DAEMON_TREE_SERVICE_H_
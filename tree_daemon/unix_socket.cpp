@@ -0,0 +1,237 @@
+#include "unix_socket.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+  [[noreturn]] void fail(const std::string &what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+  }
+
+  sockaddr_un unix_address(const std::string &path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path) {
+      throw std::runtime_error("socket path too long: " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+  }
+
+} // namespace
+
+SealedTree::~SealedTree() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+SealedTree::SealedTree(SealedTree &&other) noexcept
+    : fd_(std::exchange(other.fd_, -1)), size_(std::exchange(other.size_, 0)) {}
+
+SealedTree& SealedTree::operator=(SealedTree &&other) noexcept {
+  if (this != &other) {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+    fd_ = std::exchange(other.fd_, -1), size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+void SealedTree::send_to(int out) const {
+  off_t offset = 0;
+  while (static_cast<size_t>(offset) < size_) {
+    const auto sent = ::sendfile(out, fd_, &offset, size_ - offset);
+    if (sent > 0) {
+      continue ;
+    }
+    if (sent < 0 and errno == EINTR) {
+      continue ;
+    }
+    if (sent < 0 and (errno == EINVAL or errno == ENOSYS) and offset == 0) {
+      // "out" takes no sendfile: copy through the mapping instead
+      const auto data = bytes();
+      for (size_t done = 0; done < data.size();) {
+        const auto wrote = ::write(out, data.data() + done, data.size() - done);
+        if (wrote < 0 and errno != EINTR) {
+          fail("cannot write tree");
+        }
+        done += wrote > 0 ? wrote : 0;
+      }
+      return ;
+    }
+    fail("cannot send tree");
+  }
+}
+
+std::string SealedTree::bytes() const {
+  if (size_ == 0) {
+    return {};
+  }
+  void *p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+  if (p == MAP_FAILED) {
+    fail("cannot map tree");
+  }
+  std::string data(static_cast<const char*>(p), size_);
+  ::munmap(p, size_);
+  return data;
+}
+
+SealedTree seal_tree(const std::string &bytes) {
+  const int fd = ::memfd_create("otree", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    fail("cannot create memory file");
+  }
+  SealedTree tree(fd, bytes.size());
+  for (size_t done = 0; done < bytes.size();) {
+    const auto wrote = ::write(fd, bytes.data() + done, bytes.size() - done);
+    if (wrote < 0 and errno != EINTR) {
+      fail("cannot fill memory file");
+    }
+    done += wrote > 0 ? wrote : 0;
+  }
+  if (::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0) {
+    fail("cannot seal memory file");
+  }
+  return tree;
+}
+
+int listen_unix(const std::string &path) {
+  const auto addr = unix_address(path);
+  const int sock = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (sock < 0) {
+    fail("cannot create socket");
+  }
+  struct stat st{};
+  if (::lstat(path.c_str(), &st) == 0 and S_ISSOCK(st.st_mode)) {
+    ::unlink(path.c_str());
+  }
+  if (::bind(sock, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) < 0
+      or ::listen(sock, SOMAXCONN) < 0) {
+    const int error = errno;
+    ::close(sock);
+    errno = error;
+    fail("cannot listen at " + path);
+  }
+  return sock;
+}
+
+bool read_line(int sock, std::string &buffer, std::string &line) {
+  for (size_t scanned = 0;;) {
+    const auto eol = buffer.find('\n', scanned);
+    if (eol != std::string::npos) {
+      line.assign(buffer, 0, eol);
+      buffer.erase(0, eol + 1);
+      return true;
+    }
+    scanned = buffer.size();
+    char chunk[4096];
+    const auto got = ::recv(sock, chunk, sizeof chunk, 0);
+    if (got < 0) {
+      if (errno == EINTR) {
+        continue ;
+      }
+      fail("cannot read request");
+    }
+    if (got == 0) {
+      return false;
+    }
+    buffer.append(chunk, got);
+  }
+}
+
+void send_line(int sock, const std::string &line, int fd) {
+  size_t done = 0;
+  if (fd >= 0) {
+    iovec iov{const_cast<char*>(line.data()), line.size()};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov, msg.msg_iovlen = 1;
+    msg.msg_control = control, msg.msg_controllen = sizeof control;
+    auto *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET, cmsg->cmsg_type = SCM_RIGHTS, cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &fd, sizeof fd);
+    ssize_t sent;
+    while ((sent = ::sendmsg(sock, &msg, MSG_NOSIGNAL)) < 0 and errno == EINTR) ;
+    if (sent < 0) {
+      fail("cannot send reply");
+    }
+    done = sent;
+  }
+  while (done < line.size()) {
+    const auto sent = ::send(sock, line.data() + done, line.size() - done, MSG_NOSIGNAL);
+    if (sent < 0 and errno != EINTR) {
+      fail("cannot send reply");
+    }
+    done += sent > 0 ? sent : 0;
+  }
+}
+
+TreeClient::TreeClient(const std::string &path) {
+  const auto addr = unix_address(path);
+  sock_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (sock_ < 0) {
+    fail("cannot create socket");
+  }
+  if (::connect(sock_, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) < 0) {
+    const int error = errno;
+    ::close(sock_);
+    errno = error;
+    fail("cannot connect to " + path);
+  }
+}
+
+TreeClient::~TreeClient() {
+  ::close(sock_);
+}
+
+SealedTree TreeClient::request(const std::string &line) {
+  send_line(sock_, line + " handoff=fd\n");
+  // The reply is a single line, with the descriptor riding on its first byte
+  std::string reply;
+  int fd = -1;
+  while (reply.empty() or reply.back() != '\n') {
+    char chunk[256];
+    iovec iov{chunk, sizeof chunk};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov, msg.msg_iovlen = 1;
+    msg.msg_control = control, msg.msg_controllen = sizeof control;
+    const auto got = ::recvmsg(sock_, &msg, MSG_CMSG_CLOEXEC);
+    if (got < 0) {
+      if (errno == EINTR) {
+        continue ;
+      }
+      fail("cannot read reply");
+    }
+    if (got == 0) {
+      throw std::runtime_error("otreed hung up");
+    }
+    for (auto *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET and cmsg->cmsg_type == SCM_RIGHTS) {
+        std::memcpy(&fd, CMSG_DATA(cmsg), sizeof fd);
+      }
+    }
+    reply.append(chunk, got);
+  }
+  reply.pop_back();
+  if (reply.rfind("OK ", 0) != 0 or fd < 0) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    throw std::runtime_error(reply.rfind("ERR ", 0) == 0 ? reply.substr(4) : "bad reply from otreed: " + reply);
+  }
+  return {fd, std::stoull(reply.substr(3))};
+}
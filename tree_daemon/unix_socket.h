@@ -0,0 +1,58 @@
+#ifndef GENTREE_TREE_DAEMON_UNIX_SOCKET_H_
+#define GENTREE_TREE_DAEMON_UNIX_SOCKET_H_
+
+#include <cstddef>
+#include <string>
+
+/**
+ * A serialized tree in a sealed memory file: whoever holds the descriptor can map it or
+ * sendfile it, and nobody can change it. Handing one over passes the descriptor, not the bytes.
+ */
+class SealedTree {
+  int fd_ = -1;
+  size_t size_ = 0;
+ public:
+  SealedTree() = default;
+  SealedTree(int fd, size_t size) : fd_(fd), size_(size) {}
+  ~SealedTree();
+  SealedTree(SealedTree &&other) noexcept;
+  SealedTree& operator=(SealedTree &&other) noexcept;
+  SealedTree(const SealedTree&) = delete;
+  SealedTree& operator=(const SealedTree&) = delete;
+
+  [[nodiscard]] int fd() const { return fd_; }
+  [[nodiscard]] size_t size() const { return size_; }
+  // Copies the tree to "out" within the kernel; throws std::runtime_error on failure
+  void send_to(int out) const;
+  [[nodiscard]] std::string bytes() const;
+};
+
+// Copies "bytes" into a new sealed memory file; throws std::runtime_error on failure
+SealedTree seal_tree(const std::string &bytes);
+
+// A socket listening at "path", replacing a stale socket file; throws std::runtime_error
+int listen_unix(const std::string &path);
+
+// Reads one line from "sock" into "line" (without the '\n'); "buffer" keeps what was read past it.
+// False once the peer hangs up; throws std::runtime_error on errors
+bool read_line(int sock, std::string &buffer, std::string &line);
+
+// Writes "line" whole and, when "fd" is not -1, passes that descriptor along with its first byte;
+// throws std::runtime_error on failure
+void send_line(int sock, const std::string &line, int fd= -1);
+
+// A connection to otreed, for one request at a time
+class TreeClient {
+  int sock_;
+ public:
+  // Throws std::runtime_error when nothing listens at "path"
+  explicit TreeClient(const std::string &path);
+  ~TreeClient();
+  TreeClient(const TreeClient&) = delete;
+  TreeClient& operator=(const TreeClient&) = delete;
+  // Sends one request line (tree_service.h) asking for the descriptor handoff, and returns the tree;
+  // throws std::runtime_error with the daemon's message when it refuses
+  SealedTree request(const std::string &line);
+};
+
+#endif //GENTREE_TREE_DAEMON_UNIX_SOCKET_H_
@@ -0,0 +1,85 @@
+//
+// Builds a query workload, with reference answers, for a tree written by otree
+//
+#include "query_workload.h"
+#include "tree_oracle.h"
+
+#include "phase_stats.h"
+#include "tree_loader.h"
+
+#include "gflags/gflags.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+DEFINE_string(input, "", "tree in any otree format (default: standard input)");
+DEFINE_string(output, "", "workload path (default: standard output)");
+DEFINE_uint64(queries, 1000000ull, "number of queries");
+DEFINE_string(kinds, "lca,la,path,subtree", "comma-separated query kinds, taken in turn: lca, la, path, subtree");
+DEFINE_uint64(seed, 0ull, "seed of the queries (0: random)");
+DEFINE_uint64(threads, 0ull, "threads used to load, build and answer (0: one per core)");
+DEFINE_string(stats, "", "write per-phase timings and memory usage as JSON to this path");
+
+int main(int argc, char **argv) {
+  gflags::SetUsageMessage("Usage: treequeries -input <tree> -output <workload> -queries <count> -kinds <lca,la,path,subtree>");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (not FLAGS_stats.empty()) {
+    PhaseStats::instance().enable("treequeries");
+  }
+
+  std::vector<QueryKind> kinds;
+  {
+    std::istringstream is(FLAGS_kinds);
+    for (std::string item; std::getline(is, item, ',');) {
+      const auto kind = parse_query_kind(item);
+      if (not kind) {
+        std::cerr << "unknown query kind " << item << std::endl;
+        return 1;
+      }
+      kinds.push_back(*kind);
+    }
+  }
+  if (kinds.empty()) {
+    std::cerr << "no query kinds" << std::endl;
+    return 1;
+  }
+
+  const auto threads = FLAGS_threads ? static_cast<unsigned>(FLAGS_threads)
+                                     : std::max(1u, std::thread::hardware_concurrency());
+  auto seed = FLAGS_seed;
+  if (seed == 0) {
+    std::random_device dev;
+    seed = (static_cast<std::uint64_t>(dev()) << 32) | dev();
+  }
+  try {
+    const auto tree = load_tree(FLAGS_input, threads);
+    const TreeOracle oracle(tree.n, tree.edges, tree.weights, threads);
+    auto queries = make_queries(oracle, kinds, FLAGS_queries, seed, threads);
+    const auto start = std::chrono::steady_clock::now();
+    answer_queries(oracle, queries, threads);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cerr << "answered " << queries.size() << " queries in " << elapsed.count() << "s ("
+              << queries.size() / std::max(elapsed.count(), 1e-9) / 1e6 << "M/s)" << std::endl;
+    if (FLAGS_output != "") {
+      std::ofstream ofs(FLAGS_output, std::ios::binary);
+      write_workload(ofs, tree.n, tree.base, queries);
+    } else {
+      write_workload(std::cout, tree.n, tree.base, queries);
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  if (not FLAGS_stats.empty() and not PhaseStats::instance().write_json(FLAGS_stats)) {
+    std::cerr << "cannot write stats to " << FLAGS_stats << std::endl;
+    return 1;
+  }
+  return 0;
+}
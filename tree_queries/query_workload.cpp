@@ -0,0 +1,133 @@
+#include "query_workload.h"
+
+#include "buffered_writer.h"
+#include "phase_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+
+namespace {
+
+  // Queries are drawn and answered in chunks of this many, handed out to the threads
+  constexpr std::uint64_t kChunk = 1u << 16;
+
+  template<typename Fn>
+  void parallel_chunks(std::uint64_t count, unsigned threads, Fn &&fn) {
+    const auto chunks = (count + kChunk - 1) / kChunk;
+    std::atomic<std::uint64_t> next{0};
+    auto work = [&] {
+      for (std::uint64_t c; (c = next.fetch_add(1)) < chunks;) {
+        fn(c, c * kChunk, std::min(count, (c + 1) * kChunk));
+      }
+    };
+    threads = std::max(1u, static_cast<unsigned>(std::min<std::uint64_t>(threads, chunks)));
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+      workers.emplace_back(work);
+    }
+    work();
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
+} // namespace
+
+std::optional<QueryKind> parse_query_kind(const std::string &name) {
+  for (auto kind : {QueryKind::kLca, QueryKind::kLevelAncestor, QueryKind::kPathWeight, QueryKind::kSubtreeSum}) {
+    if (name == query_kind_name(kind)) {
+      return kind;
+    }
+  }
+  return std::nullopt;
+}
+
+const char *query_kind_name(QueryKind kind) {
+  switch (kind) {
+    case QueryKind::kLca:
+      return "lca";
+    case QueryKind::kLevelAncestor:
+      return "la";
+    case QueryKind::kPathWeight:
+      return "path";
+    case QueryKind::kSubtreeSum:
+      return "subtree";
+  }
+  return "";
+}
+
+std::vector<QueryRecord> make_queries(const TreeOracle &oracle, const std::vector<QueryKind> &kinds,
+                                      std::uint64_t count, std::uint64_t seed, unsigned threads) {
+  ScopedPhase phase("queries");
+  std::vector<QueryRecord> queries(kinds.empty() ? 0 : count);
+  const auto n = static_cast<std::uint32_t>(oracle.size());
+  parallel_chunks(queries.size(), threads, [&](std::uint64_t c, std::uint64_t lo, std::uint64_t hi) {
+    std::mt19937_64 rng(seed ^ (0x9e3779b97f4a7c15ull * (c + 1)));
+    std::uniform_int_distribution<std::uint32_t> node(0, n - 1);
+    for (auto i = lo; i < hi; ++i) {
+      auto &q = queries[i];
+      q.kind = kinds[i % kinds.size()];
+      q.u = node(rng);
+      switch (q.kind) {
+        case QueryKind::kLevelAncestor:
+          q.v = std::uniform_int_distribution<std::uint32_t>(0, oracle.depth(q.u))(rng);
+          break ;
+        case QueryKind::kSubtreeSum:
+          q.v = 0;
+          break ;
+        default:
+          q.v = node(rng);
+      }
+      q.reserved = 0, q.answer = 0;
+    }
+  });
+  return queries;
+}
+
+void answer_queries(const TreeOracle &oracle, std::vector<QueryRecord> &queries, unsigned threads) {
+  ScopedPhase phase("answer");
+  parallel_chunks(queries.size(), threads, [&](std::uint64_t, std::uint64_t lo, std::uint64_t hi) {
+    for (auto i = lo; i < hi; ++i) {
+      auto &q = queries[i];
+      switch (q.kind) {
+        case QueryKind::kLca:
+          q.answer = oracle.lca(q.u, q.v);
+          break ;
+        case QueryKind::kLevelAncestor:
+          q.answer = oracle.level_ancestor(q.u, q.v);
+          break ;
+        case QueryKind::kPathWeight:
+          q.answer = oracle.path_weight(q.u, q.v);
+          break ;
+        case QueryKind::kSubtreeSum:
+          q.answer = oracle.subtree_sum(q.u);
+          break ;
+      }
+    }
+  });
+}
+
+void write_workload(std::ostream &os, std::uint64_t n, std::uint64_t dx, const std::vector<QueryRecord> &queries) {
+  ScopedPhase phase("write");
+  QueryWorkloadHeader header{};
+  std::copy(kQueryWorkloadMagic, kQueryWorkloadMagic + 4, header.magic);
+  header.record_bytes = sizeof(QueryRecord);
+  header.n = n;
+  header.dx = dx;
+  header.count = queries.size();
+  BufferedWriter out(os);
+  out.write_raw(header);
+  for (auto q : queries) {
+    q.u += dx;
+    if (q.kind != QueryKind::kLevelAncestor and q.kind != QueryKind::kSubtreeSum) {
+      q.v += dx;
+    }
+    if (q.kind == QueryKind::kLca or q.kind == QueryKind::kLevelAncestor) {
+      q.answer += dx;
+    }
+    out.write_raw(q);
+  }
+  out.flush();
+}
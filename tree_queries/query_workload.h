@@ -0,0 +1,60 @@
+#ifndef GENTREE_TREE_QUERIES_QUERY_WORKLOAD_H_
+#define GENTREE_TREE_QUERIES_QUERY_WORKLOAD_H_
+
+#include "tree_oracle.h"
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * The queries of a workload, with the meaning of the record fields:
+ *  kLca           -- u, v; the answer is their lowest common ancestor
+ *  kLevelAncestor -- u, v; the answer is the ancestor of u at depth v
+ *  kPathWeight    -- u, v; the answer is the total weight of the nodes on the path
+ *  kSubtreeSum    -- u; the answer is the total weight of the subtree of u
+ */
+enum class QueryKind : std::uint32_t {
+  kLca = 0,
+  kLevelAncestor = 1,
+  kPathWeight = 2,
+  kSubtreeSum = 3
+};
+
+std::optional<QueryKind> parse_query_kind(const std::string &name);
+const char *query_kind_name(QueryKind kind);
+
+constexpr char kQueryWorkloadMagic[4] = {'O', 'T', 'Q', '1'};
+
+// A workload file is a QueryWorkloadHeader and "count" QueryRecords, all little-endian;
+// node ids (and answers that are nodes) start from "dx", like the ids of the tree
+struct QueryWorkloadHeader {
+  char magic[4];
+  std::uint32_t record_bytes;
+  std::uint64_t n;
+  std::uint64_t dx;
+  std::uint64_t count;
+};
+static_assert(sizeof(QueryWorkloadHeader) == 32, "QueryWorkloadHeader must stay packed");
+
+struct QueryRecord {
+  QueryKind kind;
+  std::uint32_t u;
+  std::uint32_t v;
+  std::uint32_t reserved;
+  std::int64_t answer;
+};
+static_assert(sizeof(QueryRecord) == 24, "QueryRecord must stay packed");
+
+// "count" queries of the given kinds in turn, on uniformly random nodes (0-based, unanswered);
+// the same seed gives the same queries for any number of threads
+std::vector<QueryRecord> make_queries(const TreeOracle &oracle, const std::vector<QueryKind> &kinds,
+                                      std::uint64_t count, std::uint64_t seed, unsigned threads= 1);
+
+void answer_queries(const TreeOracle &oracle, std::vector<QueryRecord> &queries, unsigned threads= 1);
+
+void write_workload(std::ostream &os, std::uint64_t n, std::uint64_t dx, const std::vector<QueryRecord> &queries);
+
+#endif //GENTREE_TREE_QUERIES_QUERY_WORKLOAD_H_
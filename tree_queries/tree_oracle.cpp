@@ -0,0 +1,210 @@
+#include "tree_oracle.h"
+
+#include "phase_stats.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+
+  // Runs fn(i) for every i in [0, n), on up to "threads" contiguous slices
+  template<typename Fn>
+  void parallel_for(size_t n, unsigned threads, Fn &&fn) {
+    threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::min<size_t>(n / 4096 + 1, 1024))));
+    auto slice = [&](unsigned t) {
+      for (auto i = n * t / threads, hi = n * (t + 1) / threads; i < hi; ++i) {
+        fn(i);
+      }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+      workers.emplace_back(slice, t);
+    }
+    slice(0);
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
+} // namespace
+
+TreeOracle::TreeOracle(size_t n, const std::vector<tree_edge> &edges,
+                       const std::vector<std::int64_t> &weights, unsigned threads) {
+  ScopedPhase phase("oracle");
+  if (n == 0 or edges.size() != n - 1) {
+    throw std::runtime_error("a tree on " + std::to_string(n) + " nodes needs " + std::to_string(n ? n - 1 : 0) + " edges");
+  }
+  if (not weights.empty() and weights.size() != n) {
+    throw std::runtime_error("expected " + std::to_string(n) + " weights");
+  }
+  auto weight = [&](std::uint32_t x) -> std::int64_t { return weights.empty() ? 1 : weights[x]; };
+
+  // children in CSR form, keeping their input order
+  constexpr auto kNone = static_cast<std::uint32_t>(-1);
+  parent_.assign(n, kNone);
+  std::vector<std::uint32_t> offset(n + 1, 0), children(n - 1);
+  for (const auto &[x, y] : edges) {
+    if (x >= n or y >= n or parent_[y] != kNone) {
+      throw std::runtime_error("not a tree: bad edge " + std::to_string(x) + " " + std::to_string(y));
+    }
+    parent_[y] = x;
+    ++offset[x + 1];
+  }
+  for (size_t x = 0; x < n; ++x) {
+    offset[x + 1] += offset[x];
+  }
+  {
+    auto next = offset;
+    for (const auto &[x, y] : edges) {
+      children[next[x]++] = y;
+    }
+  }
+  root_ = static_cast<std::uint32_t>(std::find(parent_.begin(), parent_.end(), kNone) - parent_.begin());
+  if (root_ == n) {
+    throw std::runtime_error("not a tree: no root");
+  }
+
+  // one iterative DFS for the preorder, the depths and the Euler tour
+  depth_.assign(n, 0);
+  tin_.assign(n, 0);
+  first_.assign(n, 0);
+  preorder_.reserve(n);
+  euler_.reserve(2 * n - 1);
+  euler_depth_.reserve(2 * n - 1);
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> stack;
+  stack.emplace_back(root_, offset[root_]);
+  tin_[root_] = 0, first_[root_] = 0;
+  preorder_.push_back(root_);
+  euler_.push_back(root_), euler_depth_.push_back(0);
+  while (not stack.empty()) {
+    auto &[x, next] = stack.back();
+    if (next == offset[x + 1]) {
+      stack.pop_back();
+      if (not stack.empty()) {
+        const auto p = stack.back().first;
+        euler_.push_back(p), euler_depth_.push_back(depth_[p]);
+      }
+      continue ;
+    }
+    const auto y = children[next++];
+    depth_[y] = depth_[x] + 1;
+    tin_[y] = static_cast<std::uint32_t>(preorder_.size());
+    first_[y] = static_cast<std::uint32_t>(euler_.size());
+    preorder_.push_back(y);
+    euler_.push_back(y), euler_depth_.push_back(depth_[y]);
+    stack.emplace_back(y, offset[y]);
+  }
+  if (preorder_.size() != n) {
+    throw std::runtime_error("not a tree: some nodes are not reachable from the root");
+  }
+
+  size_.assign(n, 1);
+  path_sum_.assign(n, 0);
+  preorder_sum_.assign(n + 1, 0);
+  for (size_t i = n; i-- > 1;) {
+    size_[parent_[preorder_[i]]] += size_[preorder_[i]];
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const auto x = preorder_[i];
+    path_sum_[x] = (x == root_ ? 0 : path_sum_[parent_[x]]) + weight(x);
+    preorder_sum_[i + 1] = preorder_sum_[i] + weight(x);
+  }
+
+  // the preorder ranks grouped by depth, by a stable counting sort
+  const auto height = *std::max_element(depth_.begin(), depth_.end());
+  level_start_.assign(height + 2, 0);
+  for (auto d : depth_) {
+    ++level_start_[d + 1];
+  }
+  for (size_t d = 0; d <= height; ++d) {
+    level_start_[d + 1] += level_start_[d];
+  }
+  level_tin_.resize(n);
+  {
+    auto next = level_start_;
+    for (std::uint32_t i = 0; i < n; ++i) {
+      level_tin_[next[depth_[preorder_[i]]]++] = i;
+    }
+  }
+
+  build_rmq(threads);
+}
+
+void TreeOracle::build_rmq(unsigned threads) {
+  ScopedPhase phase("rmq");
+  const auto m = euler_.size();
+  const auto blocks = ((m - 1) >> kBlockBits) + 1;
+  masks_.assign(m, 0);
+  std::vector<std::uint32_t> block_min(blocks);
+  parallel_for(blocks, threads, [&](size_t b) {
+    const auto lo = b << kBlockBits, hi = std::min(m, lo + (1u << kBlockBits));
+    std::uint64_t mask = 0;
+    for (auto i = lo; i < hi; ++i) {
+      // pop the deeper (or equal) positions off the stack; the highest remaining bit is the top
+      while (mask and euler_depth_[lo + 63 - __builtin_clzll(mask)] >= euler_depth_[i]) {
+        mask &= ~(1ull << (63 - __builtin_clzll(mask)));
+      }
+      mask |= 1ull << (i - lo);
+      masks_[i] = mask;
+    }
+    // the bottom of the stack is the minimum of the block
+    block_min[b] = static_cast<std::uint32_t>(lo + __builtin_ctzll(masks_[hi - 1]));
+  });
+  sparse_.clear();
+  sparse_.push_back(std::move(block_min));
+  for (size_t k = 1; (size_t{1} << k) <= blocks; ++k) {
+    const auto &prev = sparse_[k - 1];
+    const auto half = size_t{1} << (k - 1);
+    std::vector<std::uint32_t> level(blocks - (size_t{1} << k) + 1);
+    parallel_for(level.size(), threads, [&](size_t b) {
+      level[b] = shallower(prev[b], prev[b + half]);
+    });
+    sparse_.push_back(std::move(level));
+  }
+}
+
+std::uint32_t TreeOracle::shallower(std::uint32_t i, std::uint32_t j) const {
+  return euler_depth_[j] < euler_depth_[i] ? j : i;
+}
+
+std::uint32_t TreeOracle::in_block_min(std::uint32_t l, std::uint32_t r) const {
+  assert(l >> kBlockBits == r >> kBlockBits and l <= r);
+  const auto base = l & ~((1u << kBlockBits) - 1);
+  return base + __builtin_ctzll(masks_[r] & (~0ull << (l - base)));
+}
+
+std::uint32_t TreeOracle::lca(std::uint32_t u, std::uint32_t v) const {
+  auto l = first_[u], r = first_[v];
+  if (l > r) {
+    std::swap(l, r);
+  }
+  const auto bl = l >> kBlockBits, br = r >> kBlockBits;
+  if (bl == br) {
+    return euler_[in_block_min(l, r)];
+  }
+  auto best = shallower(in_block_min(l, ((bl + 1) << kBlockBits) - 1), in_block_min(br << kBlockBits, r));
+  if (br - bl > 1) {
+    const auto k = 31 - __builtin_clz(br - bl - 1);
+    best = shallower(best, shallower(sparse_[k][bl + 1], sparse_[k][br - (1u << k)]));
+  }
+  return euler_[best];
+}
+
+std::uint32_t TreeOracle::level_ancestor(std::uint32_t v, std::uint32_t d) const {
+  assert(d <= depth_[v]);
+  // the last node of depth d at or before v in preorder
+  const auto begin = level_tin_.begin() + level_start_[d], end = level_tin_.begin() + level_start_[d + 1];
+  return preorder_[*(std::upper_bound(begin, end, tin_[v]) - 1)];
+}
+
+std::int64_t TreeOracle::path_weight(std::uint32_t u, std::uint32_t v) const {
+  const auto a = lca(u, v);
+  return path_sum_[u] + path_sum_[v] - path_sum_[a] - (a == root_ ? 0 : path_sum_[parent_[a]]);
+}
+
+std::int64_t TreeOracle::subtree_sum(std::uint32_t v) const {
+  return preorder_sum_[tin_[v] + size_[v]] - preorder_sum_[tin_[v]];
+}
@@ -0,0 +1,59 @@
+//
+// Reference answers to tree queries, for checking and benchmarking query data structures:
+// LCA is a range-minimum over the Euler tour, answered by in-block stack masks
+// and a sparse table over the blocks.
+//
+
+#ifndef GENTREE_TREE_QUERIES_TREE_ORACLE_H_
+#define GENTREE_TREE_QUERIES_TREE_ORACLE_H_
+
+#include "tree_loader.h"
+
+#include <cstdint>
+#include <vector>
+
+class TreeOracle {
+ public:
+  /**
+   * "edges" are the (parent, child) pairs of a tree over 0..n-1, rooted at the one node
+   * without a parent; "weights" holds one weight per node, or nothing for unit weights.
+   * The tables are built by up to "threads" threads.
+   * Throws std::runtime_error if the edges do not form a tree.
+   */
+  TreeOracle(size_t n, const std::vector<tree_edge> &edges,
+             const std::vector<std::int64_t> &weights, unsigned threads= 1);
+
+  [[nodiscard]] size_t size() const { return parent_.size(); }
+  [[nodiscard]] std::uint32_t root() const { return root_; }
+  [[nodiscard]] std::uint32_t depth(std::uint32_t x) const { return depth_[x]; }
+
+  [[nodiscard]] std::uint32_t lca(std::uint32_t u, std::uint32_t v) const;
+  // the ancestor of v at depth d <= depth(v)
+  [[nodiscard]] std::uint32_t level_ancestor(std::uint32_t v, std::uint32_t d) const;
+  // the total weight of the nodes on the path between u and v, both included
+  [[nodiscard]] std::int64_t path_weight(std::uint32_t u, std::uint32_t v) const;
+  // the total weight of the subtree of v
+  [[nodiscard]] std::int64_t subtree_sum(std::uint32_t v) const;
+
+ private:
+  static constexpr unsigned kBlockBits = 6;
+
+  [[nodiscard]] std::uint32_t in_block_min(std::uint32_t l, std::uint32_t r) const;
+  [[nodiscard]] std::uint32_t shallower(std::uint32_t i, std::uint32_t j) const;
+  void build_rmq(unsigned threads);
+
+  std::uint32_t root_ = 0;
+  std::vector<std::uint32_t> parent_, depth_, tin_, size_;
+  // root-to-node weights, and prefix sums of the weights in preorder
+  std::vector<std::int64_t> path_sum_, preorder_sum_;
+  // the Euler tour, the depth along it, and the first visit of every node
+  std::vector<std::uint32_t> euler_, euler_depth_, first_;
+  // bit j of masks_[i] marks position (i & ~63) + j on the min-stack of its block, up to i
+  std::vector<std::uint64_t> masks_;
+  // sparse_[k][b]: the tour position of the minimum over blocks b..b+2^k-1
+  std::vector<std::vector<std::uint32_t>> sparse_;
+  // the preorder ranks of the nodes of every depth, in increasing order
+  std::vector<std::uint32_t> level_start_, level_tin_, preorder_;
+};
+
+#endif //GENTREE_TREE_QUERIES_TREE_ORACLE_H_
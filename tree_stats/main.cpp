@@ -0,0 +1,48 @@
+//
+// Validates a tree written by otree and prints its shape statistics as JSON
+//
+#include "tree_stats.h"
+
+#include "mapped_file.h"
+#include "phase_stats.h"
+
+#include "gflags/gflags.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <thread>
+
+DEFINE_string(input, "", "tree in any otree format (default: standard input)");
+DEFINE_uint64(threads, 0ull, "threads used to load edge lists that cannot be streamed (0: one per core)");
+DEFINE_string(stats, "", "write per-phase timings and memory usage as JSON to this path");
+
+int main(int argc, char **argv) {
+  gflags::SetUsageMessage("Usage: treestats -input <tree>");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  if (not FLAGS_stats.empty()) {
+    PhaseStats::instance().enable("treestats");
+  }
+
+  const auto threads = FLAGS_threads ? static_cast<unsigned>(FLAGS_threads)
+                                     : std::max(1u, std::thread::hardware_concurrency());
+  try {
+    const MappedFile file(FLAGS_input);
+    const auto start = std::chrono::steady_clock::now();
+    const auto stats = tree_stats(file.data(), file.size(), threads);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cerr << "checked " << stats.n << " nodes in " << elapsed.count() << "s ("
+              << file.size() / std::max(elapsed.count(), 1e-9) / (1 << 20) << " MiB/s)" << std::endl;
+    write_stats_json(std::cout, stats, elapsed.count());
+  } catch (const std::exception &e) {
+    std::cerr << "invalid tree: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (not FLAGS_stats.empty() and not PhaseStats::instance().write_json(FLAGS_stats)) {
+    std::cerr << "cannot write stats to " << FLAGS_stats << std::endl;
+    return 1;
+  }
+  return 0;
+}
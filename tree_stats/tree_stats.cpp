@@ -0,0 +1,667 @@
+#include "tree_stats.h"
+
+#include "int_scanner.h"
+#include "mapped_file.h"
+#include "phase_stats.h"
+#include "tree_loader.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+
+  constexpr auto kNone = std::numeric_limits<std::uint32_t>::max();
+
+  // The distributions of a tree, or of the part of it measured so far
+  struct Histograms {
+    static constexpr size_t kSmallDegrees = 64;
+    std::vector<std::uint64_t> depths;
+    std::array<std::uint64_t, kSmallDegrees> small_degrees{};
+    std::map<std::uint64_t, std::uint64_t> large_degrees;
+    std::array<std::uint64_t, 64> sizes{};
+
+    void node_at(size_t depth) {
+      if (depth >= depths.size()) {
+        depths.resize(2 * depth + 2);
+      }
+      ++depths[depth];
+    }
+
+    // a node with a subtree of "size" nodes and "children" children
+    void closed(std::uint64_t size, std::uint64_t children) {
+      ++sizes[63 - __builtin_clzll(size)];
+      if (children < kSmallDegrees) {
+        ++small_degrees[children];
+      } else {
+        ++large_degrees[children];
+      }
+    }
+
+    void add(const Histograms &other) {
+      if (other.depths.size() > depths.size()) {
+        depths.resize(other.depths.size());
+      }
+      for (size_t d = 0; d < other.depths.size(); ++d) {
+        depths[d] += other.depths[d];
+      }
+      for (size_t k = 0; k < kSmallDegrees; ++k) {
+        small_degrees[k] += other.small_degrees[k];
+      }
+      for (const auto &[k, count] : other.large_degrees) {
+        large_degrees[k] += count;
+      }
+      for (size_t k = 0; k < sizes.size(); ++k) {
+        sizes[k] += other.sizes[k];
+      }
+    }
+
+    void finish(TreeStats &stats) {
+      auto top = depths.size();
+      for (; top > 0 and depths[top - 1] == 0; --top) ;
+      depths.resize(top);
+      stats.leaves = small_degrees[0];
+      stats.height = depths.empty() ? 0 : depths.size() - 1;
+      stats.depths = std::move(depths);
+      stats.degrees = std::move(large_degrees);
+      for (size_t k = 0; k < kSmallDegrees; ++k) {
+        if (small_degrees[k] > 0) {
+          stats.degrees[k] = small_degrees[k];
+        }
+      }
+      top = sizes.size();
+      for (; top > 0 and sizes[top - 1] == 0; --top) ;
+      stats.subtree_sizes.assign(sizes.begin(), sizes.begin() + top);
+    }
+  };
+
+  // Visits the nodes of a tree in preorder, as "open" and "close" events, keeping
+  // only the current root path: the preorder ranks of its nodes and their child counts so far
+  class Accumulator {
+    struct Frame {
+      std::uint64_t id;
+      std::uint64_t children;
+    };
+    std::vector<Frame> path_;
+    std::uint64_t next_ = 0;
+    Histograms hist_;
+   public:
+    // nodes opened so far; the next one is given this preorder rank
+    [[nodiscard]] std::uint64_t count() const { return next_; }
+
+    void open() {
+      if (not path_.empty()) {
+        ++path_.back().children;
+      }
+      hist_.node_at(path_.size());
+      path_.push_back({next_++, 0});
+    }
+
+    void close() {
+      // the subtree of the node is itself and everything opened after it
+      hist_.closed(next_ - path_.back().id, path_.back().children);
+      path_.pop_back();
+    }
+
+    // The edge (p, c) of an edge list, 0-based: false unless c is the next node in preorder and p lies on
+    // the current root path, in which case the nodes below p are closed and c is opened
+    bool edge(std::uint64_t p, std::uint64_t c) {
+      if (c != next_) {
+        return false;
+      }
+      for (; not path_.empty() and path_.back().id != p; close()) ;
+      if (path_.empty()) {
+        return false;
+      }
+      open();
+      return true;
+    }
+
+    void finish(TreeStats &stats) {
+      for (; not path_.empty(); close()) ;
+      stats.n = next_;
+      hist_.finish(stats);
+    }
+  };
+
+  void add_weight(TreeStats &stats, std::int64_t w) {
+    if (stats.weights++ == 0) {
+      stats.min_weight = stats.max_weight = w;
+    } else {
+      stats.min_weight = std::min(stats.min_weight, w), stats.max_weight = std::max(stats.max_weight, w);
+    }
+  }
+
+  // The number of tokens on the first non-blank line after the one "p" is on, leaving "p" past that line
+  size_t next_line_tokens(const char *&p, const char *end) {
+    for (; p < end and *p != '\n'; ++p) ;
+    for (; p < end and IntScanner::is_space(*p); ++p) ;
+    size_t tokens = 0;
+    while (p < end and *p != '\n') {
+      if (IntScanner::is_space(*p)) {
+        ++p;
+        continue ;
+      }
+      ++tokens;
+      for (; p < end and not IntScanner::is_space(*p); ++p) ;
+    }
+    return tokens;
+  }
+
+  // 8 parentheses per 64-bit word: '(' is 0x28 and ')' 0x29, so everything but the low bit
+  // of every byte is fixed, and the low bits are the closing parentheses
+  constexpr std::uint64_t kLowBits = 0x0101010101010101ull;
+  constexpr std::uint64_t kParenBits = 0x2828282828282828ull;
+
+  // Sets bit i of "closes" when byte i at "p" is ')'; false if one of the 8 bytes is not a parenthesis
+  inline bool close_bits(const char *p, std::uint64_t &closes) {
+    std::uint64_t w;
+    std::memcpy(&w, p, sizeof w);
+    // gathers the low bit of byte i into bit 56 + i
+    closes = ((w & kLowBits) * 0x0102040810204080ull) >> 56;
+    return (w & ~kLowBits) == kParenBits;
+  }
+
+  // The closing parentheses among the 64 bytes at "p", or false if not all of them are parentheses
+  inline bool close_mask(const char *p, std::uint64_t &closes) {
+    closes = 0;
+    bool parens = true;
+    for (int k = 0; k < 8; ++k) {
+      std::uint64_t bits;
+      parens &= close_bits(p + 8*k, bits);
+      closes |= bits << (8*k);
+    }
+    return parens;
+  }
+
+  // The length of the parentheses at the start of [p, end) and their excess
+  std::pair<size_t, std::int64_t> paren_run(const char *p, const char *end) {
+    const char *q = p;
+    std::int64_t excess = 0;
+    for (std::uint64_t closes; end - q >= 64 and close_mask(q, closes); q += 64) {
+      excess += 64 - 2 * __builtin_popcountll(closes);
+    }
+    for (; q < end and (*q == '(' or *q == ')'); ++q) {
+      excess += *q == '(' ? 1 : -1;
+    }
+    return {q - p, excess};
+  }
+
+  // One slice of a parentheses sequence, scanned on its own: the nodes that open and close within it
+  // are measured on the spot, and the path it leaves or finds open is handed on to be stitched
+  class BpSlice {
+   public:
+    struct Frame {
+      std::uint64_t pos;
+      std::uint64_t children;
+    };
+    // nodes opened before the slice and closed in it, deepest first: their closing positions,
+    // and the children they gained in the slice
+    std::vector<Frame> outer_closes;
+    // children gained in the slice by the deepest node opened before it and still open after it
+    std::uint64_t outer_children = 0;
+    // nodes opened in the slice and still open after it, from the top down: their opening positions
+    // and the children they gained
+    std::vector<Frame> opens;
+    Histograms hist;
+
+    // Scans the parentheses at the start of the "len" bytes at "p", which start at position "offset"
+    // of the sequence, "depth" nodes deep; returns how many there are
+    size_t scan(const char *p, size_t len, std::uint64_t offset, std::uint64_t depth) {
+      // Slot d+1 keeps the opening position and the child count of the node at depth d while its
+      // descendants are scanned; the node on top stays in registers, and closes write to slot 0.
+      // The size and degree histograms have four copies, so that consecutive updates of one count
+      // (as at every leaf) do not wait on each other.
+      std::vector<std::uint64_t> pos(depth + 66), children(depth + 66), depths(depth + 66);
+      std::uint64_t sizes[4][64] = {}, degrees[4][Histograms::kSmallDegrees + 1] = {};
+      std::uint64_t start = 0, cur = 0, d = depth, floor = depth;
+      auto step = [&](std::uint64_t c, std::uint64_t at, int copy) {
+        const std::uint64_t o = c ^ 1, m = 0 - o;
+        if (d == floor) {
+          // the path below the nodes of the slice
+          if (c) {
+            if (floor == 0) {
+              throw std::runtime_error("unbalanced parentheses sequence");
+            }
+            outer_closes.push_back({at, cur});
+            --floor, --d, start = 0, cur = 0;
+            return ;
+          }
+          if (d == 0 and at > 0) {
+            throw std::runtime_error("balanced parentheses sequence describes a forest");
+          }
+        }
+        // (an open computes a bucket too, and adds nothing to it)
+        sizes[copy][63 - __builtin_clzll(((at - start + 1) >> 1) | 1)] += c;
+        degrees[copy][std::min<std::uint64_t>(cur, Histograms::kSmallDegrees)] += c;
+        if (c and cur >= Histograms::kSmallDegrees) {
+          ++hist.large_degrees[cur];
+        }
+        depths[d] += o;
+        const auto slot = (d + 1) & m;
+        pos[slot] = start, children[slot] = cur + 1;
+        start = (at & m) | (pos[d] & ~m);
+        cur = children[d] & ~m;
+        d = d + o - c;
+      };
+      // room for the slots of "more" nodes opened on top of the current one
+      auto reserve = [&](std::uint64_t more) {
+        if (d + more + 2 > pos.size()) {
+          const auto size = std::max<std::uint64_t>(d + more + 2, 2 * pos.size());
+          pos.resize(size), children.resize(size), depths.resize(size);
+        }
+      };
+      size_t i = 0;
+      for (std::uint64_t closes; len - i >= 64 and close_mask(p + i, closes); i += 64) {
+        reserve(64);
+        for (int j = 0; j < 64; ++j, closes >>= 1) {
+          step(closes & 1, offset + i + j, j & 3);
+        }
+      }
+      // the rest, which may all open, byte by byte
+      auto tail = i;
+      for (; tail < len and (p[tail] == '(' or p[tail] == ')'); ++tail) ;
+      reserve(tail - i);
+      for (; i < tail; ++i) {
+        step(p[i] == ')', offset + i, 0);
+      }
+      if (d > floor) {
+        outer_children = children[floor + 1];
+        opens.push_back({start, cur});
+        for (auto k = d - 1; k > floor; --k) {
+          opens.push_back({pos[k + 1], children[k + 1]});
+        }
+      } else {
+        outer_children = cur;
+      }
+      hist.depths = std::move(depths);
+      for (int copy = 0; copy < 4; ++copy) {
+        for (size_t k = 0; k < Histograms::kSmallDegrees; ++k) {
+          hist.small_degrees[k] += degrees[copy][k];
+        }
+        for (size_t k = 0; k < 64; ++k) {
+          hist.sizes[k] += sizes[copy][k];
+        }
+      }
+      return i;
+    }
+  };
+
+  void bp_stats(TreeStats &stats, const char *p, const char *end, unsigned threads) {
+    // Each thread takes a slice; a first pass finds where the parentheses stop, and how deep each slice starts
+    constexpr size_t kMinSlice = 1 << 20;
+    const auto size = static_cast<size_t>(end - p);
+    threads = std::max(1u, std::min<unsigned>(threads, size / kMinSlice));
+    std::vector<size_t> cuts{0};
+    for (unsigned t = 1; t < threads; ++t) {
+      cuts.push_back(size / threads * t);
+    }
+    cuts.push_back(size);
+    std::vector<std::pair<size_t, std::int64_t>> runs(threads);
+    std::vector<BpSlice> slices(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    auto run = [threads](auto &&work) {
+      std::vector<std::thread> workers;
+      for (unsigned t = 1; t < threads; ++t) {
+        workers.emplace_back(work, t);
+      }
+      work(0);
+      for (auto &w : workers) {
+        w.join();
+      }
+    };
+    if (threads == 1) {
+      runs[0] = {size, 0};
+    } else {
+      run([&](unsigned t) {
+        runs[t] = paren_run(p + cuts[t], p + cuts[t+1]);
+      });
+    }
+    // the slices past the first other byte are dropped
+    unsigned used = 0;
+    std::vector<std::int64_t> depth(threads + 1, 0);
+    for (bool more = true; used < threads and more; ++used) {
+      more = runs[used].first == cuts[used+1] - cuts[used];
+      depth[used + 1] = depth[used] + runs[used].second;
+    }
+    run([&](unsigned t) {
+      if (t >= used) {
+        return ;
+      }
+      try {
+        // a slice that would start below the root follows one that fails
+        runs[t].first = slices[t].scan(p + cuts[t], runs[t].first, cuts[t], std::max<std::int64_t>(depth[t], 0));
+      } catch (...) {
+        errors[t] = std::current_exception();
+      }
+    });
+    for (auto &e : errors) {
+      if (e) {
+        std::rethrow_exception(e);
+      }
+    }
+    const auto length = cuts[used - 1] + runs[used - 1].first;
+    if (length == 0) {
+      throw std::runtime_error("malformed balanced parentheses sequence");
+    }
+    if (threads > 1 and depth[used] != 0) {
+      throw std::runtime_error("unbalanced parentheses sequence");
+    }
+
+    // Stitches the nodes that span slices along the root path
+    Histograms hist;
+    std::vector<BpSlice::Frame> path;
+    for (unsigned t = 0; t < used; ++t) {
+      auto &slice = slices[t];
+      for (const auto &[at, children] : slice.outer_closes) {
+        const auto f = path.back();
+        path.pop_back();
+        hist.closed((at - f.pos + 1) / 2, f.children + children);
+      }
+      if (not path.empty()) {
+        path.back().children += slice.outer_children;
+      }
+      path.insert(path.end(), slice.opens.rbegin(), slice.opens.rend());
+      hist.add(slice.hist);
+    }
+    if (not path.empty()) {
+      throw std::runtime_error("unbalanced parentheses sequence");
+    }
+    stats.n = length / 2;
+    hist.finish(stats);
+    IntScanner in(p + length, end);
+    for (std::int64_t w; in.next(w);) {
+      add_weight(stats, w);
+    }
+    if (stats.weights > 0 and stats.weights != stats.n) {
+      throw std::runtime_error("expected " + std::to_string(stats.n) + " weights, found " + std::to_string(stats.weights));
+    }
+  }
+
+  // An id below the base; it matches no node
+  constexpr auto kBadId = std::numeric_limits<std::uint64_t>::max();
+
+  // The edges at "p", read by read_edge(p, parent, child) as 0-based ids, in depth-first preorder: false
+  // as soon as one is not
+  template<typename ReadEdge>
+  bool preorder_edges(TreeStats &stats, std::uint64_t n, const char *p, ReadEdge read_edge) {
+    Accumulator acc;
+    acc.open();
+    std::uint64_t edges = 0;
+    for (std::uint64_t x, y; read_edge(p, x, y);) {
+      if (++edges >= n) {
+        throw std::runtime_error("more than " + std::to_string(n - 1) + " edges for " + std::to_string(n) + " nodes");
+      }
+      if (not acc.edge(x, y)) {
+        return false;
+      }
+    }
+    if (edges + 1 != n) {
+      throw std::runtime_error("expected " + std::to_string(n - 1) + " edges, found " + std::to_string(edges));
+    }
+    acc.finish(stats);
+    return true;
+  }
+
+  // The same for edges grouped by parent, the groups in increasing parent order and ids in preorder, as
+  // print and write_binary emit them. The tree is walked in preorder: when a node is reached its group,
+  // if it has one, is next in the input and is skipped, and the node on the root path keeps where the
+  // group starts, to read its children from there one at a time (each edge is read twice, in O(height)
+  // memory). False as soon as an edge is not where this order puts it.
+  template<typename ReadEdge>
+  bool grouped_edges(TreeStats &stats, std::uint64_t n, const char *p, ReadEdge read_edge) {
+    struct Group {
+      std::uint64_t parent;
+      const char *next;
+      std::uint64_t left;
+    };
+    std::vector<Group> path;
+    Accumulator acc;
+    acc.open();
+    std::uint64_t edges = 0, v = 0, x, y;
+    auto group = p;
+    bool more = read_edge(p, x, y);
+    for (;;) {
+      if (more and x == v) {
+        path.push_back({v, group, 0});
+        for (; more and x == v; group = p, more = read_edge(p, x, y)) {
+          if (++edges >= n) {
+            throw std::runtime_error("more than " + std::to_string(n - 1) + " edges for " + std::to_string(n) + " nodes");
+          }
+          ++path.back().left;
+        }
+      }
+      if (more and x < v) {
+        return false;
+      }
+      // the next node in preorder is the next child of the deepest node with children left
+      for (; not path.empty() and path.back().left == 0; path.pop_back()) ;
+      if (path.empty()) {
+        break ;
+      }
+      auto &g = path.back();
+      std::uint64_t parent, child;
+      read_edge(g.next, parent, child);
+      --g.left;
+      if (not acc.edge(g.parent, child)) {
+        return false;
+      }
+      v = child;
+    }
+    if (more) {
+      return false;
+    }
+    if (edges + 1 != n) {
+      throw std::runtime_error("expected " + std::to_string(n - 1) + " edges, found " + std::to_string(edges));
+    }
+    acc.finish(stats);
+    return true;
+  }
+
+  // false when the edges are in neither order above, and the tree has to be loaded instead
+  bool text_stats(TreeStats &stats, const char *p, const char *end) {
+    IntScanner in(p, end);
+    std::int64_t n;
+    if (not in.next(n) or n < 1) {
+      throw std::runtime_error("missing node count in tree input");
+    }
+    stats.n = n;
+    // The line after n holds the weights unless it is an edge; a pair of weights is told from one
+    // by the edge that follows it
+    const char *q = in.position();
+    const auto tokens = next_line_tokens(q, end);
+    const bool has_weights = tokens > 0 and (tokens != 2 or (n <= 2 and next_line_tokens(q, end) > 0));
+    std::int64_t w;
+    for (std::int64_t v = 0; has_weights and v < n; ++v) {
+      if (not in.next(w)) {
+        throw std::runtime_error("expected " + std::to_string(n) + " weights, found " + std::to_string(v));
+      }
+      add_weight(stats, w);
+    }
+    // the root, which comes first in either order, gives the base of the ids
+    const auto edges = in.position();
+    std::int64_t root = 0;
+    if (in.next(root) and root != 0 and root != 1) {
+      return false;
+    }
+    stats.base = root;
+    auto read_edge = [end, root](const char *&at, std::uint64_t &x, std::uint64_t &y) {
+      IntScanner ids(at, end);
+      std::int64_t a, b;
+      if (not ids.next(a)) {
+        return false;
+      }
+      if (not ids.next(b)) {
+        throw std::runtime_error("odd number of ids in edge list");
+      }
+      at = ids.position();
+      x = a < root ? kBadId : a - root, y = b < root ? kBadId : b - root;
+      return true;
+    };
+    return preorder_edges(stats, n, edges, read_edge) or grouped_edges(stats, n, edges, read_edge);
+  }
+
+  template<typename Id>
+  inline std::uint64_t read_id(const char *&p) {
+    Id id;
+    std::memcpy(&id, p, sizeof id);
+    p += sizeof id;
+    return id;
+  }
+
+  bool binary_stats(TreeStats &stats, const char *p, const char *end) {
+    BinaryTreeHeader header{};
+    if (static_cast<size_t>(end - p) < sizeof header) {
+      throw std::runtime_error("truncated binary tree header");
+    }
+    std::memcpy(&header, p, sizeof header);
+    p += sizeof header;
+    if (header.id_bytes != 4 and header.id_bytes != 8) {
+      throw std::runtime_error("unsupported id width in binary tree");
+    }
+    if (header.n == 0) {
+      throw std::runtime_error("binary tree without nodes");
+    }
+    stats.n = header.n, stats.base = header.dx;
+    const auto expected = (header.has_weights ? header.n * sizeof(std::int64_t) : 0)
+                          + 2 * (header.n - 1) * header.id_bytes;
+    if (static_cast<size_t>(end - p) < expected) {
+      throw std::runtime_error("truncated binary tree");
+    }
+    if (static_cast<size_t>(end - p) > expected) {
+      throw std::runtime_error("trailing bytes after binary tree");
+    }
+    for (std::uint64_t v = 0; header.has_weights and v < header.n; ++v) {
+      add_weight(stats, static_cast<std::int64_t>(read_id<std::uint64_t>(p)));
+    }
+    auto read_edge = [end, &header](const char *&at, std::uint64_t &x, std::uint64_t &y) {
+      if (at == end) {
+        return false;
+      }
+      x = header.id_bytes == 4 ? read_id<std::uint32_t>(at) : read_id<std::uint64_t>(at);
+      y = header.id_bytes == 4 ? read_id<std::uint32_t>(at) : read_id<std::uint64_t>(at);
+      x = x < header.dx ? kBadId : x - header.dx, y = y < header.dx ? kBadId : y - header.dx;
+      return true;
+    };
+    return preorder_edges(stats, header.n, p, read_edge) or grouped_edges(stats, header.n, p, read_edge);
+  }
+
+  // Loads the whole edge list and walks it from its root: O(n) memory
+  void loaded_stats(TreeStats &stats, const char *data, size_t size, unsigned threads) {
+    const auto tree = load_tree(data, size, threads);
+    const auto n = static_cast<std::uint32_t>(tree.n);
+    const auto id = [&tree](std::uint32_t v) { return std::to_string(v + tree.base); };
+    std::vector<std::uint32_t> parent(n, kNone), offset(n + 1, 0);
+    for (const auto &[x, y] : tree.edges) {
+      if (x == y) {
+        throw std::runtime_error("node " + id(x) + " is its own parent");
+      }
+      if (parent[y] != kNone) {
+        throw std::runtime_error("node " + id(y) + " has two parents");
+      }
+      parent[y] = x, ++offset[x + 1];
+    }
+    // n-1 edges with distinct children leave exactly one node without a parent
+    const auto root = static_cast<std::uint32_t>(std::find(parent.begin(), parent.end(), kNone) - parent.begin());
+    for (std::uint32_t v = 0; v < n; ++v) {
+      offset[v + 1] += offset[v];
+    }
+    std::vector<std::uint32_t> children(tree.edges.size()), fill(offset.begin(), offset.end() - 1);
+    for (const auto &[x, y] : tree.edges) {
+      children[fill[x]++] = y;
+    }
+    fill.clear(), fill.shrink_to_fit();
+    Accumulator acc;
+    // (node, index of its next child) along the current root path
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> st{{root, offset[root]}};
+    acc.open();
+    while (not st.empty()) {
+      auto &[x, k] = st.back();
+      if (k == offset[x + 1]) {
+        acc.close(), st.pop_back();
+        continue ;
+      }
+      const auto y = children[k++];
+      st.emplace_back(y, offset[y]);
+      acc.open();
+    }
+    if (acc.count() != n) {
+      throw std::runtime_error(std::to_string(n - acc.count()) + " nodes are not connected to the root " + id(root));
+    }
+    acc.finish(stats);
+    stats.base = tree.base;
+    stats.streamed = false;
+    for (const auto w : tree.weights) {
+      add_weight(stats, w);
+    }
+  }
+
+} // namespace
+
+TreeStats tree_stats(const char *data, size_t size, unsigned threads) {
+  ScopedPhase phase("scan");
+  TreeStats stats;
+  const char *end = data + size;
+  if (size >= sizeof kBinaryTreeMagic and std::memcmp(data, kBinaryTreeMagic, sizeof kBinaryTreeMagic) == 0) {
+    stats.format = TreeFormat::kBinary;
+    if (not binary_stats(stats, data, end)) {
+      stats = TreeStats{};
+      stats.format = TreeFormat::kBinary;
+      loaded_stats(stats, data, size, threads);
+    }
+    return stats;
+  }
+  const char *p = data;
+  for (; p < end and IntScanner::is_space(*p); ++p) ;
+  if (p < end and *p == '(') {
+    stats.format = TreeFormat::kBP;
+    bp_stats(stats, p, end, threads);
+    return stats;
+  }
+  if (not text_stats(stats, p, end)) {
+    stats = TreeStats{};
+    loaded_stats(stats, data, size, threads);
+  }
+  return stats;
+}
+
+TreeStats tree_stats(const std::string &path, unsigned threads) {
+  const MappedFile file(path);
+  return tree_stats(file.data(), file.size(), threads);
+}
+
+void write_stats_json(std::ostream &os, const TreeStats &stats, double seconds) {
+  os << "{\n  \"format\": \"" << tree_format_name(stats.format) << "\",\n  \"n\": " << stats.n
+     << ",\n  \"base\": " << stats.base << ",\n  \"streamed\": " << (stats.streamed ? "true" : "false")
+     << ",\n  \"seconds\": " << seconds << ",\n  \"leaves\": " << stats.leaves
+     << ",\n  \"height\": " << stats.height << ",\n  \"depths\": [";
+  for (size_t d = 0; d < stats.depths.size(); ++d) {
+    os << (d ? ", " : "") << stats.depths[d];
+  }
+  os << "],\n  \"degrees\": [";
+  bool first = true;
+  for (const auto &[k, count] : stats.degrees) {
+    os << (first ? "" : ", ") << '[' << k << ", " << count << ']';
+    first = false;
+  }
+  // every bucket is named by its smallest size
+  os << "],\n  \"subtree_sizes\": [";
+  first = true;
+  for (size_t k = 0; k < stats.subtree_sizes.size(); ++k) {
+    if (stats.subtree_sizes[k] > 0) {
+      os << (first ? "" : ", ") << '[' << (std::uint64_t{1} << k) << ", " << stats.subtree_sizes[k] << ']';
+      first = false;
+    }
+  }
+  os << "]";
+  if (stats.weights > 0) {
+    os << ",\n  \"weights\": {\"count\": " << stats.weights << ", \"min\": " << stats.min_weight
+       << ", \"max\": " << stats.max_weight << '}';
+  }
+  os << "\n}\n";
+}
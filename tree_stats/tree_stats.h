@@ -0,0 +1,47 @@
+#ifndef GENTREE_TREE_STATS_TREE_STATS_H_
+#define GENTREE_TREE_STATS_TREE_STATS_H_
+
+#include "tree_format.h"
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct TreeStats {
+  TreeFormat format = TreeFormat::kText;
+  std::uint64_t n = 0;
+  // the smallest id of the input (0 or 1)
+  std::uint64_t base = 0;
+  // false when the edges came in neither order that is streamed and the whole tree had to be loaded
+  bool streamed = true;
+  std::uint64_t leaves = 0;
+  // edges on the longest root-to-leaf path
+  std::uint64_t height = 0;
+  // depths[d] nodes lie d edges below the root
+  std::vector<std::uint64_t> depths;
+  // degrees[k] nodes have k children
+  std::map<std::uint64_t, std::uint64_t> degrees;
+  // subtree_sizes[k] nodes have subtrees (as calcCard counts them, with the node itself)
+  // of 2^k..2^(k+1)-1 nodes
+  std::vector<std::uint64_t> subtree_sizes;
+  std::uint64_t weights = 0;
+  std::int64_t min_weight = 0, max_weight = 0;
+};
+
+/**
+ * Checks the tree in "data", in any format otree writes, and measures it in the same pass:
+ * the parentheses must balance and close only at the end, and an edge list must have n-1 edges,
+ * one root and every node reachable from it. Parentheses, and edges between preorder ids either
+ * in depth-first preorder (as the external writer emits them) or grouped by parent (as print and
+ * write_binary do), are streamed with the current root path as the only state; other edge lists,
+ * such as relabeled ones, are loaded whole with up to "threads" threads.
+ * Throws std::runtime_error naming the first defect found.
+ */
+TreeStats tree_stats(const char *data, size_t size, unsigned threads= 1);
+TreeStats tree_stats(const std::string &path, unsigned threads= 1);
+
+void write_stats_json(std::ostream &os, const TreeStats &stats, double seconds);
+
+#endif //GENTREE_TREE_STATS_TREE_STATS_H_
@@ -114,4 +114,11 @@ void Graph::transform( node_type x, const Graph &src ) {
 
 void Graph::serialize(std::ostream &os) const {
   _serialize(os,0);
-}
\ No newline at end of file
+}
+std::vector<std::uint32_t> Graph::parents() const {
+  std::vector<std::uint32_t> res(V, 0);
+  for ( node_type x= 0; x < V; ++x )
+    for ( auto z: adj[x] )
+      res[z]= x;
+  return res;
+}
@@ -31,6 +31,8 @@ class Graph {
   void add_node( node_type x );
   void transform( node_type x, const Graph &src );
   void serialize( std::ostream &os ) const;
+  // parent of every node (the root, 0, is its own parent)
+  [[nodiscard]] std::vector<std::uint32_t> parents() const;
 };
 
 #endif //GENTREE_UTILS_GRAPHS_GRAPH_H_
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "async_writer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+AsyncWriteBuf::AsyncWriteBuf(const std::string &path, size_t buffers, size_t capacity)
+    : capacity_(capacity) {
+  if (path.empty() or path == "-") {
+    fd_ = STDOUT_FILENO;
+  } else {
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+      throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+    }
+    owns_fd_ = true;
+  }
+  // Only a file of our own is written by position: pwrite leaves the offset of an inherited
+  // stdout where it was, so whatever is written there after us would land over our output.
+  // Pipes cannot seek at all. Both are written in order instead.
+  const auto offset = owns_fd_ ? ::lseek(fd_, 0, SEEK_CUR) : -1;
+  if (offset >= 0) {
+    positional_ = true;
+    offset_ = offset;
+  }
+  buffers = std::max<size_t>(buffers, 2);
+  for (size_t i = 0; i < buffers; ++i) {
+    buffers_.push_back(std::make_unique<char[]>(capacity_));
+    free_.push_back(buffers_.back().get());
+  }
+  auto *first = free_.back();
+  free_.pop_back();
+  setp(first, first + capacity_);
+  io_ = std::thread(&AsyncWriteBuf::run, this);
+}
+
+AsyncWriteBuf::~AsyncWriteBuf() {
+  try {
+    close();
+  } catch (const std::exception&) {
+    // errors surface through close() or the stream state
+  }
+}
+
+void AsyncWriteBuf::close() {
+  if (closed_) {
+    return ;
+  }
+  closed_ = true;
+  submit();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  io_.join();
+  setp(nullptr, nullptr);
+  if (owns_fd_ and ::close(fd_) != 0 and error_ == 0) {
+    error_ = errno;
+  }
+  if (error_ != 0) {
+    throw std::runtime_error(std::string("write failed: ") + std::strerror(error_));
+  }
+}
+
+bool AsyncWriteBuf::submit() {
+  const auto size = static_cast<size_t>(pptr() - pbase());
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (size > 0) {
+    pending_.emplace_back(pbase(), size);
+    ++busy_;
+    cv_.notify_all();
+    cv_.wait(lock, [this] { return not free_.empty(); });
+    auto *next = free_.back();
+    free_.pop_back();
+    setp(next, next + capacity_);
+  }
+  return error_ == 0;
+}
+
+AsyncWriteBuf::int_type AsyncWriteBuf::overflow(int_type ch) {
+  if (closed_ or not submit()) {
+    return traits_type::eof();
+  }
+  if (not traits_type::eq_int_type(ch, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+int AsyncWriteBuf::sync() {
+  if (closed_) {
+    return 0;
+  }
+  submit();
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return busy_ == 0; });
+  return error_ == 0 ? 0 : -1;
+}
+
+void AsyncWriteBuf::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    cv_.wait(lock, [this] { return stopping_ or not pending_.empty(); });
+    if (pending_.empty()) {
+      return ;
+    }
+    const auto [data, size] = pending_.front();
+    pending_.pop_front();
+    // after a failure the rest is dropped, but buffers keep cycling so the producer never blocks
+    const auto skip = error_ != 0;
+    lock.unlock();
+    const auto err = skip ? 0 : write_all(data, size);
+    lock.lock();
+    if (err != 0) {
+      error_ = err;
+    }
+    free_.push_back(data);
+    --busy_;
+    cv_.notify_all();
+  }
+}
+
+int AsyncWriteBuf::write_all(const char *data, size_t size) {
+  while (size > 0) {
+    const auto written = positional_ ? ::pwrite(fd_, data, size, offset_) : ::write(fd_, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue ;
+      }
+      return errno;
+    }
+    data += written, size -= static_cast<size_t>(written);
+    offset_ += written;
+  }
+  return 0;
+}
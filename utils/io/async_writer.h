@@ -0,0 +1,75 @@
+#ifndef GENTREE_UTILS_IO_ASYNC_WRITER_H_
+#define GENTREE_UTILS_IO_ASYNC_WRITER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Output buffer whose disk writes run on a background thread: the producer fills
+ * one of "buffers" buffers while the others are written out. When all of them are in
+ * flight the producer waits, so memory stays bounded by buffers * capacity.
+ * Only a file the writer opened itself is written with pwrite; standard output is
+ * written with write, so that it stays at the offset whatever writes there next expects.
+ * A failed write puts the stream in the bad state; close() reports it.
+ */
+class AsyncWriteBuf : public std::streambuf {
+ public:
+  // an empty path or "-" stands for the standard output; throws std::runtime_error if it cannot be opened
+  explicit AsyncWriteBuf(const std::string &path, size_t buffers= 4, size_t capacity= 1 << 20);
+  ~AsyncWriteBuf() override;
+  AsyncWriteBuf(const AsyncWriteBuf&) = delete;
+  AsyncWriteBuf& operator=(const AsyncWriteBuf&) = delete;
+  // writes everything out and stops the I/O thread; throws std::runtime_error if a write failed
+  void close();
+
+ protected:
+  int_type overflow(int_type ch) override;
+  int sync() override;
+
+ private:
+  // hands the filled part of the current buffer to the I/O thread and takes a free one
+  bool submit();
+  void run();
+  int write_all(const char *data, size_t size);
+
+  int fd_ = -1;
+  bool owns_fd_ = false, positional_ = false, closed_ = false;
+  off_t offset_ = 0;
+  size_t capacity_;
+  std::vector<std::unique_ptr<char[]>> buffers_;
+  std::vector<char*> free_;
+  std::deque<std::pair<char*, size_t>> pending_;
+  // buffers queued or being written
+  size_t busy_ = 0;
+  int error_ = 0;
+  bool stopping_ = false;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread io_;
+};
+
+// An std::ostream over its own AsyncWriteBuf, for the writers that take a stream
+class AsyncOstream : public std::ostream {
+  AsyncWriteBuf buf_;
+ public:
+  explicit AsyncOstream(const std::string &path, size_t buffers= 4, size_t capacity= 1 << 20)
+      : std::ostream(nullptr), buf_(path, buffers, capacity) {
+    rdbuf(&buf_);
+  }
+  void close() {
+    flush();
+    buf_.close();
+  }
+};
+
+#endif //GENTREE_UTILS_IO_ASYNC_WRITER_H_
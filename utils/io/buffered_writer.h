@@ -0,0 +1,69 @@
+#ifndef GENTREE_UTILS_IO_BUFFERED_WRITER_H_
+#define GENTREE_UTILS_IO_BUFFERED_WRITER_H_
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+
+/**
+ * Accumulates output in a large buffer and hands it to the stream in big
+ * sequential writes; integers are formatted by hand rather than by the locale-aware ostream.
+ */
+class BufferedWriter {
+  std::ostream &os_;
+  std::vector<char> buf_;
+  size_t len_ = 0;
+ public:
+  explicit BufferedWriter(std::ostream &os, size_t capacity= 1 << 20) : os_(os), buf_(capacity) {}
+  ~BufferedWriter() { flush(); }
+  BufferedWriter(const BufferedWriter&) = delete;
+  BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+  void flush() {
+    os_.write(buf_.data(), static_cast<std::streamsize>(len_));
+    len_ = 0;
+  }
+  void put(char ch) {
+    if (len_ == buf_.size()) {
+      flush();
+    }
+    buf_[len_++] = ch;
+  }
+  void write(const char *data, size_t len) {
+    if (len_ + len > buf_.size()) {
+      flush();
+      if (len > buf_.size()) {
+        os_.write(data, static_cast<std::streamsize>(len));
+        return ;
+      }
+    }
+    std::memcpy(buf_.data() + len_, data, len);
+    len_ += len;
+  }
+  void write_uint(std::uint64_t v) {
+    char digits[20];
+    int k = 0;
+    do {
+      digits[k++] = static_cast<char>('0' + v % 10);
+    } while (v /= 10);
+    if (len_ + k > buf_.size()) {
+      flush();
+    }
+    for (; k > 0; buf_[len_++] = digits[--k]) ;
+  }
+  void write_int(std::int64_t v) {
+    if (v < 0) {
+      put('-');
+      write_uint(static_cast<std::uint64_t>(0) - static_cast<std::uint64_t>(v));
+    } else {
+      write_uint(static_cast<std::uint64_t>(v));
+    }
+  }
+  template<typename T>
+  void write_raw(const T &v) {
+    write(reinterpret_cast<const char*>(&v), sizeof v);
+  }
+};
+
+#endif //GENTREE_UTILS_IO_BUFFERED_WRITER_H_
@@ -0,0 +1,49 @@
+#ifndef GENTREE_UTILS_IO_INT_SCANNER_H_
+#define GENTREE_UTILS_IO_INT_SCANNER_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Reads the whitespace-separated integers of a text tree input one at a time,
+ * by hand rather than through the locale-aware istream.
+ * Throws std::runtime_error on anything but an optional '-' and digits between the spaces.
+ */
+class IntScanner {
+  const char *p_, *end_;
+ public:
+  IntScanner(const char *p, const char *end) : p_(p), end_(end) {}
+
+  static bool is_space(char ch) { return ch == ' ' or ch == '\n' or ch == '\r' or ch == '\t'; }
+  static bool is_digit(char ch) { return static_cast<unsigned char>(ch - '0') < 10; }
+
+  // where the next integer is looked for
+  [[nodiscard]] const char *position() const { return p_; }
+
+  // The next integer into "value"; false at the end of the input
+  bool next(std::int64_t &value) {
+    for (; p_ < end_ and is_space(*p_); ++p_) ;
+    if (p_ == end_) {
+      return false;
+    }
+    bool negative = false;
+    if (*p_ == '-') {
+      negative = true, ++p_;
+    }
+    if (p_ == end_ or not is_digit(*p_)) {
+      throw std::runtime_error(std::string("unexpected character '") + (p_ == end_ ? '-' : *p_) + "' in tree input");
+    }
+    std::uint64_t v = 0;
+    for (; p_ < end_ and is_digit(*p_); ++p_) {
+      v = v * 10 + static_cast<unsigned>(*p_ - '0');
+    }
+    if (p_ < end_ and not is_space(*p_)) {
+      throw std::runtime_error(std::string("unexpected character '") + *p_ + "' in tree input");
+    }
+    value = negative ? -static_cast<std::int64_t>(v) : static_cast<std::int64_t>(v);
+    return true;
+  }
+};
+
+#endif //GENTREE_UTILS_IO_INT_SCANNER_H_
@@ -0,0 +1,69 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+MappedFile::MappedFile(const std::string &path) {
+  if (path.empty() or path == "-") {
+    open_fd(STDIN_FILENO, "<stdin>");
+    return ;
+  }
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+  }
+  try {
+    open_fd(fd, path);
+  } catch (...) {
+    ::close(fd);
+    throw ;
+  }
+  ::close(fd);
+}
+
+void MappedFile::open_fd(int fd, const std::string &what) {
+  struct stat st{};
+  if (::fstat(fd, &st) == 0 and S_ISREG(st.st_mode) and st.st_size > 0) {
+    const auto offset = ::lseek(fd, 0, SEEK_CUR);
+    const auto start = offset > 0 ? static_cast<size_t>(offset) : 0;
+    void *p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+      ::madvise(p, st.st_size, MADV_SEQUENTIAL);
+      mapping_ = p;
+      data_ = static_cast<const char*>(p) + start;
+      size_ = st.st_size - start;
+      return ;
+    }
+  }
+  // not mappable: slurp it
+  constexpr size_t kChunk = 1 << 20;
+  for (;;) {
+    const auto old = buffer_.size();
+    buffer_.resize(old + kChunk);
+    const auto got = ::read(fd, buffer_.data() + old, kChunk);
+    if (got < 0) {
+      if (errno == EINTR) {
+        buffer_.resize(old);
+        continue ;
+      }
+      throw std::runtime_error("cannot read " + what + ": " + std::strerror(errno));
+    }
+    buffer_.resize(old + got);
+    if (got == 0) {
+      break ;
+    }
+  }
+  data_ = buffer_.data(), size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() {
+  if (mapping_ != nullptr) {
+    ::munmap(mapping_, size_ + (data_ - static_cast<const char*>(mapping_)));
+  }
+}
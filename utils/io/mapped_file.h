@@ -0,0 +1,30 @@
+#ifndef GENTREE_UTILS_IO_MAPPED_FILE_H_
+#define GENTREE_UTILS_IO_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Read-only view of a whole input. Regular files are mmap-ed; anything that
+ * cannot be mapped (pipes, terminals) is read into an owned buffer instead.
+ * Throws std::runtime_error when the input cannot be opened or read.
+ */
+class MappedFile {
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  void *mapping_ = nullptr;
+  std::vector<char> buffer_;
+  void open_fd(int fd, const std::string &what);
+ public:
+  // an empty path or "-" stands for the standard input
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  [[nodiscard]] const char *data() const { return data_; }
+  [[nodiscard]] size_t size() const { return size_; }
+  [[nodiscard]] bool mapped() const { return mapping_ != nullptr; }
+};
+
+#endif //GENTREE_UTILS_IO_MAPPED_FILE_H_
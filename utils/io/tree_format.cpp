@@ -0,0 +1,23 @@
+#include "tree_format.h"
+
+std::optional<TreeFormat> parse_tree_format(const std::string &name) {
+  if (name == "text") {
+    return TreeFormat::kText;
+  }
+  if (name == "bp") {
+    return TreeFormat::kBP;
+  }
+  if (name == "binary") {
+    return TreeFormat::kBinary;
+  }
+  return std::nullopt;
+}
+
+const char *tree_format_name(TreeFormat format) {
+  switch (format) {
+    case TreeFormat::kText: return "text";
+    case TreeFormat::kBP: return "bp";
+    case TreeFormat::kBinary: return "binary";
+  }
+  return "unknown";
+}
@@ -0,0 +1,35 @@
+#ifndef GENTREE_UTILS_IO_TREE_FORMAT_H_
+#define GENTREE_UTILS_IO_TREE_FORMAT_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * The encodings otree writes and the loaders accept:
+ *  kText   -- "n", an optional line of n weights, then n-1 "parent child" lines
+ *  kBP     -- the balanced parentheses sequence on one line, optionally followed by n weights
+ *  kBinary -- a BinaryTreeHeader, n int64 weights if present, then n-1 (parent, child) pairs
+ */
+enum class TreeFormat {
+  kText,
+  kBP,
+  kBinary
+};
+
+std::optional<TreeFormat> parse_tree_format(const std::string &name);
+const char *tree_format_name(TreeFormat format);
+
+constexpr char kBinaryTreeMagic[4] = {'O', 'T', 'B', '1'};
+
+// All fields little-endian; ids are stored in "id_bytes" (4 or 8) bytes each
+struct BinaryTreeHeader {
+  char magic[4];
+  std::uint32_t id_bytes;
+  std::uint64_t n;
+  std::uint64_t dx;
+  std::uint64_t has_weights;
+};
+static_assert(sizeof(BinaryTreeHeader) == 32, "BinaryTreeHeader must stay packed");
+
+#endif //GENTREE_UTILS_IO_TREE_FORMAT_H_
@@ -0,0 +1,227 @@
+#include "tree_loader.h"
+
+#include "int_scanner.h"
+#include "mapped_file.h"
+#include "phase_stats.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+  const char *skip_spaces(const char *p, const char *end) {
+    for (; p < end and IntScanner::is_space(*p); ++p) ;
+    return p;
+  }
+
+  // Appends every integer of [p, end) to "out"
+  void scan_integers(const char *p, const char *end, std::vector<std::int64_t> &out) {
+    IntScanner in(p, end);
+    for (std::int64_t v; in.next(v);) {
+      out.push_back(v);
+    }
+  }
+
+  std::vector<std::int64_t> scan_integers(const char *p, const char *end, unsigned threads) {
+    const auto size = static_cast<size_t>(end - p);
+    constexpr size_t kMinSlice = 1 << 20;
+    threads = std::max(1u, std::min<unsigned>(threads, size / kMinSlice));
+    std::vector<std::int64_t> result;
+    if (threads == 1) {
+      result.reserve(size / 4);
+      scan_integers(p, end, result);
+      return result;
+    }
+    // Cut at whitespace so that no integer straddles two slices
+    std::vector<const char*> cuts{p};
+    for (unsigned t = 1; t < threads; ++t) {
+      auto c = std::max(cuts.back(), p + size / threads * t);
+      for (; c < end and not IntScanner::is_space(*c); ++c) ;
+      cuts.push_back(c);
+    }
+    cuts.push_back(end);
+    std::vector<std::vector<std::int64_t>> parts(threads);
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        try {
+          parts[t].reserve((cuts[t+1] - cuts[t]) / 4);
+          scan_integers(cuts[t], cuts[t+1], parts[t]);
+        } catch (...) {
+          errors[t] = std::current_exception();
+        }
+      });
+    }
+    for (auto &w : workers) {
+      w.join();
+    }
+    for (auto &e : errors) {
+      if (e) {
+        std::rethrow_exception(e);
+      }
+    }
+    size_t total = 0;
+    for (const auto &part : parts) {
+      total += part.size();
+    }
+    result.reserve(total);
+    for (const auto &part : parts) {
+      result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+  }
+
+  void check_size(std::uint64_t n) {
+    if (n > std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error("tree of " + std::to_string(n) + " nodes is too large to load");
+    }
+  }
+
+  // Rebases the ids of "ids" (2(n-1) values, flattened pairs) to 0
+  void fill_edges(LoadedTree &tree, const std::int64_t *ids) {
+    const auto m = 2*(tree.n - 1);
+    if (m == 0) {
+      return ;
+    }
+    const auto [lo, hi] = std::minmax_element(ids, ids + m);
+    tree.base = *lo == 0 ? 0 : 1;
+    if (*lo < 0 or static_cast<std::uint64_t>(*hi) - tree.base >= tree.n) {
+      throw std::runtime_error("node ids out of range for a tree of " + std::to_string(tree.n) + " nodes");
+    }
+    tree.edges.resize(tree.n - 1);
+    for (size_t k = 0; k + 1 < tree.n; ++k) {
+      tree.edges[k] = {static_cast<std::uint32_t>(ids[2*k] - tree.base),
+                       static_cast<std::uint32_t>(ids[2*k+1] - tree.base)};
+    }
+  }
+
+  void load_text(LoadedTree &tree, const char *p, const char *end, unsigned threads) {
+    const auto values = scan_integers(p, end, threads);
+    if (values.empty() or values[0] < 1) {
+      throw std::runtime_error("missing node count in tree input");
+    }
+    tree.n = values[0];
+    check_size(tree.n);
+    const auto m = 2*(tree.n - 1);
+    const auto rest = values.size() - 1;
+    const std::int64_t *ids = values.data() + 1;
+    if (rest == tree.n + m) {
+      tree.weights.assign(ids, ids + tree.n);
+      ids += tree.n;
+    } else if (rest != m) {
+      throw std::runtime_error("expected " + std::to_string(tree.n - 1) + " edges, found "
+                               + std::to_string(rest) + " ids");
+    }
+    fill_edges(tree, ids);
+  }
+
+  void load_bp(LoadedTree &tree, const char *p, const char *end, unsigned threads) {
+    const char *q = p;
+    for (; q < end and (*q == '(' or *q == ')'); ++q) ;
+    tree.n = (q - p) / 2;
+    check_size(tree.n);
+    if (tree.n == 0 or (q - p) % 2) {
+      throw std::runtime_error("malformed balanced parentheses sequence");
+    }
+    // Edges in the order otree prints them: the parent arc of a node precedes its child arcs
+    tree.edges.reserve(tree.n - 1);
+    std::vector<std::uint32_t> st;
+    std::uint32_t V = 0;
+    for (; p < q; ++p) {
+      if (*p == '(') {
+        if (not st.empty()) {
+          tree.edges.emplace_back(st.back(), V);
+        } else if (V > 0) {
+          throw std::runtime_error("balanced parentheses sequence describes a forest");
+        }
+        st.push_back(V++);
+      } else {
+        if (st.empty()) {
+          throw std::runtime_error("unbalanced parentheses sequence");
+        }
+        st.pop_back();
+      }
+    }
+    if (not st.empty()) {
+      throw std::runtime_error("unbalanced parentheses sequence");
+    }
+    tree.weights = scan_integers(q, end, threads);
+    if (not tree.weights.empty() and tree.weights.size() != tree.n) {
+      throw std::runtime_error("expected " + std::to_string(tree.n) + " weights, found "
+                               + std::to_string(tree.weights.size()));
+    }
+  }
+
+  void load_binary(LoadedTree &tree, const char *p, const char *end) {
+    BinaryTreeHeader header{};
+    if (static_cast<size_t>(end - p) < sizeof header) {
+      throw std::runtime_error("truncated binary tree header");
+    }
+    std::memcpy(&header, p, sizeof header);
+    p += sizeof header;
+    if (header.id_bytes != 4 and header.id_bytes != 8) {
+      throw std::runtime_error("unsupported id width in binary tree");
+    }
+    tree.n = header.n, tree.base = header.dx;
+    check_size(tree.n);
+    const auto expected = (header.has_weights ? tree.n * sizeof(std::int64_t) : 0)
+                          + 2 * (tree.n - 1) * header.id_bytes;
+    if (tree.n == 0 or static_cast<size_t>(end - p) < expected) {
+      throw std::runtime_error("truncated binary tree");
+    }
+    if (header.has_weights) {
+      tree.weights.resize(tree.n);
+      std::memcpy(tree.weights.data(), p, tree.n * sizeof(std::int64_t));
+      p += tree.n * sizeof(std::int64_t);
+    }
+    tree.edges.resize(tree.n - 1);
+    for (auto &[x, y] : tree.edges) {
+      std::uint64_t ids[2] = {0, 0};
+      for (auto &id : ids) {
+        if (header.id_bytes == 4) {
+          std::uint32_t v;
+          std::memcpy(&v, p, 4);
+          id = v;
+        } else {
+          std::memcpy(&id, p, 8);
+        }
+        p += header.id_bytes;
+        if (id < header.dx or id - header.dx >= tree.n) {
+          throw std::runtime_error("node ids out of range in binary tree");
+        }
+      }
+      x = ids[0] - header.dx, y = ids[1] - header.dx;
+    }
+  }
+
+} // namespace
+
+LoadedTree load_tree(const char *data, size_t size, unsigned threads) {
+  ScopedPhase phase("parse");
+  LoadedTree tree;
+  const char *end = data + size;
+  if (size >= sizeof kBinaryTreeMagic and std::memcmp(data, kBinaryTreeMagic, sizeof kBinaryTreeMagic) == 0) {
+    tree.format = TreeFormat::kBinary;
+    load_binary(tree, data, end);
+    return tree;
+  }
+  const char *p = skip_spaces(data, end);
+  if (p < end and *p == '(') {
+    tree.format = TreeFormat::kBP;
+    load_bp(tree, p, end, threads);
+    return tree;
+  }
+  tree.format = TreeFormat::kText;
+  load_text(tree, p, end, threads);
+  return tree;
+}
+
+LoadedTree load_tree(const std::string &path, unsigned threads) {
+  const MappedFile file(path);
+  return load_tree(file.data(), file.size(), threads);
+}
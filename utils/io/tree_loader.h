@@ -0,0 +1,32 @@
+#ifndef GENTREE_UTILS_IO_TREE_LOADER_H_
+#define GENTREE_UTILS_IO_TREE_LOADER_H_
+
+#include "tree_format.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using tree_edge = std::pair<std::uint32_t, std::uint32_t>;
+
+struct LoadedTree {
+  TreeFormat format = TreeFormat::kText;
+  std::uint64_t n = 0;
+  // the smallest id of the input (0 or 1); edges below are always 0-based
+  std::uint64_t base = 0;
+  // (parent, child) in input order
+  std::vector<tree_edge> edges;
+  std::vector<std::int64_t> weights;
+};
+
+/**
+ * Parses any of the formats otree writes; the format is recognized from the
+ * first bytes, and for the text formats whether ids are 0- or 1-based from the ids themselves.
+ * Text is scanned by up to "threads" threads, each taking a newline-aligned slice.
+ * Throws std::runtime_error on malformed input.
+ */
+LoadedTree load_tree(const char *data, size_t size, unsigned threads= 1);
+LoadedTree load_tree(const std::string &path, unsigned threads= 1);
+
+#endif //GENTREE_UTILS_IO_TREE_LOADER_H_
@@ -8,10 +8,24 @@ rand_utils::rand_utils() {
   generator.seed(std::chrono::system_clock::now().time_since_epoch().count());
 }
 
+rand_utils::rand_utils(std::uint64_t seed) {
+  generator.seed(seed);
+}
+
 std::vector<size_t> rand_utils::rand_subset(size_t N, size_t n) {
   std::vector<size_t> res(n);
   for (size_t m= 0, t= 0; m < n; ++t)
     if ((N-t)*next_double() < n-m)
       res[m++]= t;
   return res;
-}
\ No newline at end of file
+}
+
+std::vector<std::int64_t> rand_utils::rand_weights(size_t n, std::uint64_t a, std::uint64_t b,
+                                                   std::uint64_t seed) {
+  std::vector<std::int64_t> weights(n);
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<std::mt19937::result_type> dist(a,b);
+  for(auto &x : weights)
+    x = dist(rng);
+  return weights;
+}
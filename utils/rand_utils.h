@@ -1,6 +1,7 @@
 #ifndef GENTREE__RAND_UTILS_H_
 #define GENTREE__RAND_UTILS_H_
 
+#include <cstdint>
 #include <random>
 #include <vector>
 
@@ -10,7 +11,11 @@ class rand_utils {
   double next_double();
  public:
   rand_utils();
+  explicit rand_utils(std::uint64_t seed);
   std::vector<size_t> rand_subset(size_t N, size_t n);
+  // n weights drawn uniformly from [a,b]
+  static std::vector<std::int64_t> rand_weights(size_t n, std::uint64_t a, std::uint64_t b,
+                                                std::uint64_t seed);
 };
 
-#endif //GENTREE__RAND_UTILS_H_
\ No newline at end of file
+#endif //GENTREE__RAND_UTILS_H_
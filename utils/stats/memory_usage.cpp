@@ -0,0 +1,125 @@
+#include "memory_usage.h"
+
+#include <malloc.h>
+#include <sys/resource.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+  std::atomic<bool> g_tracking{false};
+  std::atomic<std::int64_t> g_allocations{0};
+  std::atomic<std::int64_t> g_allocated_bytes{0};
+  std::atomic<std::int64_t> g_live_bytes{0};
+  std::atomic<std::int64_t> g_peak_live_bytes{0};
+
+  // Blocks may be allocated while tracking is off and released while it is on
+  // (or vice versa); the counters are signed, so callers reason about deltas only.
+  void on_allocate(void *p) {
+    const auto sz = static_cast<std::int64_t>(malloc_usable_size(p));
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(sz, std::memory_order_relaxed);
+    const auto live = g_live_bytes.fetch_add(sz, std::memory_order_relaxed) + sz;
+    auto peak = g_peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak and
+           not g_peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) ;
+  }
+
+  void on_release(void *p) {
+    g_live_bytes.fetch_sub(static_cast<std::int64_t>(malloc_usable_size(p)),
+                           std::memory_order_relaxed);
+  }
+
+  std::int64_t read_status_kb(const char *key) {
+    std::FILE *fp = std::fopen("/proc/self/status", "r");
+    if (fp == nullptr) {
+      return -1;
+    }
+    char line[256];
+    const auto len = std::strlen(key);
+    std::int64_t kb = -1;
+    while (std::fgets(line, sizeof line, fp)) {
+      if (std::strncmp(line, key, len) == 0 and line[len] == ':') {
+        kb = std::strtoll(line + len + 1, nullptr, 10);
+        break ;
+      }
+    }
+    std::fclose(fp);
+    return kb;
+  }
+
+} // namespace
+
+void *operator new(std::size_t sz) {
+  void *p = std::malloc(sz == 0 ? 1 : sz);
+  if (p == nullptr) {
+    throw std::bad_alloc{};
+  }
+  if (g_tracking.load(std::memory_order_relaxed)) {
+    on_allocate(p);
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  if (p == nullptr) {
+    return ;
+  }
+  if (g_tracking.load(std::memory_order_relaxed)) {
+    on_release(p);
+  }
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+  ::operator delete(p);
+}
+
+void MemoryUsage::track_allocations(bool on) {
+  g_tracking.store(on, std::memory_order_relaxed);
+}
+
+bool MemoryUsage::tracking_allocations() {
+  return g_tracking.load(std::memory_order_relaxed);
+}
+
+AllocationSnapshot MemoryUsage::allocations() {
+  return {g_allocations.load(std::memory_order_relaxed),
+          g_allocated_bytes.load(std::memory_order_relaxed),
+          g_live_bytes.load(std::memory_order_relaxed),
+          g_peak_live_bytes.load(std::memory_order_relaxed)};
+}
+
+void MemoryUsage::reset_peak_live() {
+  g_peak_live_bytes.store(g_live_bytes.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+}
+
+std::int64_t MemoryUsage::current_rss_bytes() {
+  const auto kb = read_status_kb("VmRSS");
+  return kb < 0 ? 0 : kb * 1024;
+}
+
+std::int64_t MemoryUsage::peak_rss_bytes() {
+  const auto kb = read_status_kb("VmHWM");
+  if (kb >= 0) {
+    return kb * 1024;
+  }
+  struct rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<std::int64_t>(usage.ru_maxrss) * 1024;
+}
+
+bool MemoryUsage::reset_peak_rss() {
+  // "5" resets the peak RSS (Linux 4.0+)
+  std::FILE *fp = std::fopen("/proc/self/clear_refs", "w");
+  if (fp == nullptr) {
+    return false;
+  }
+  const bool ok = std::fputs("5", fp) >= 0;
+  return std::fclose(fp) == 0 and ok;
+}
@@ -0,0 +1,32 @@
+#ifndef GENTREE_UTILS_STATS_MEMORY_USAGE_H_
+#define GENTREE_UTILS_STATS_MEMORY_USAGE_H_
+
+#include <cstdint>
+
+struct AllocationSnapshot {
+  std::int64_t allocations;
+  std::int64_t allocated_bytes;
+  std::int64_t live_bytes;
+  std::int64_t peak_live_bytes;
+};
+
+/**
+ * Heap accounting through a replaced global operator new/delete.
+ * Linking this library installs the hooks; they only count while tracking
+ * is switched on, so an idle binary pays a single relaxed load per allocation.
+ */
+class MemoryUsage {
+ public:
+  static void track_allocations(bool on);
+  [[nodiscard]] static bool tracking_allocations();
+  [[nodiscard]] static AllocationSnapshot allocations();
+  // restarts the peak from the current live byte count
+  static void reset_peak_live();
+  // resident set size, as reported by /proc/self/status (0 if unavailable)
+  [[nodiscard]] static std::int64_t current_rss_bytes();
+  [[nodiscard]] static std::int64_t peak_rss_bytes();
+  // restarts the kernel's high-water mark; false if the kernel refuses
+  static bool reset_peak_rss();
+};
+
+#endif //GENTREE_UTILS_STATS_MEMORY_USAGE_H_
@@ -0,0 +1,91 @@
+#include "phase_stats.h"
+
+#include "memory_usage.h"
+
+#include <algorithm>
+#include <fstream>
+
+PhaseStats::PhaseStats() : created_(std::chrono::steady_clock::now()) {}
+
+PhaseStats& PhaseStats::instance() {
+  static PhaseStats stats;
+  return stats;
+}
+
+void PhaseStats::enable(const std::string &tool) {
+  tool_ = tool;
+  created_ = std::chrono::steady_clock::now();
+  MemoryUsage::track_allocations(true);
+  owner_ = std::this_thread::get_id();
+  enabled_ = true;
+}
+
+// The heap and RSS high-water marks are process-wide, and a nested phase
+// restarts them; whatever they reached so far is credited to the enclosing phases
+// (and to the run) first.
+void PhaseStats::fold_peaks() {
+  const auto heap = MemoryUsage::allocations().peak_live_bytes;
+  const auto rss = MemoryUsage::peak_rss_bytes();
+  peak_rss_bytes_ = std::max(peak_rss_bytes_, rss);
+  for (auto &o : open_) {
+    o.peak_heap_bytes = std::max(o.peak_heap_bytes, heap - o.live_bytes);
+    o.peak_rss_bytes = std::max(o.peak_rss_bytes, rss);
+  }
+}
+
+void PhaseStats::begin(const char *name) {
+  fold_peaks();
+  MemoryUsage::reset_peak_live();
+  MemoryUsage::reset_peak_rss();
+  const auto snapshot = MemoryUsage::allocations();
+  records_.push_back({name, static_cast<int>(open_.size()), 0.0, 0, 0, 0, 0});
+  open_.push_back({records_.size() - 1, std::chrono::steady_clock::now(),
+                   snapshot.allocations, snapshot.allocated_bytes, snapshot.live_bytes,
+                   0, 0});
+}
+
+void PhaseStats::end() {
+  const auto stop = std::chrono::steady_clock::now();
+  fold_peaks();
+  const auto o = open_.back();
+  open_.pop_back();
+  const auto snapshot = MemoryUsage::allocations();
+  auto &r = records_[o.record];
+  r.seconds = std::chrono::duration<double>(stop - o.start).count();
+  r.allocations = snapshot.allocations - o.allocations;
+  r.allocated_bytes = snapshot.allocated_bytes - o.allocated_bytes;
+  r.peak_heap_bytes = o.peak_heap_bytes;
+  r.peak_rss_bytes = o.peak_rss_bytes;
+}
+
+const std::vector<PhaseRecord> &PhaseStats::records() const {
+  return records_;
+}
+
+void PhaseStats::write_json(std::ostream &os) const {
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - created_);
+  os << "{\n  \"tool\": \"" << tool_ << "\",\n"
+     << "  \"total_seconds\": " << elapsed.count() << ",\n"
+     << "  \"peak_rss_bytes\": " << std::max(peak_rss_bytes_, MemoryUsage::peak_rss_bytes()) << ",\n"
+     << "  \"phases\": [";
+  for (size_t i = 0; i < records_.size(); ++i) {
+    const auto &r = records_[i];
+    os << (i ? ",\n" : "\n")
+       << "    {\"name\": \"" << r.name << "\", \"depth\": " << r.depth
+       << ", \"seconds\": " << r.seconds
+       << ", \"allocations\": " << r.allocations
+       << ", \"allocated_bytes\": " << r.allocated_bytes
+       << ", \"peak_heap_bytes\": " << r.peak_heap_bytes
+       << ", \"peak_rss_bytes\": " << r.peak_rss_bytes << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+bool PhaseStats::write_json(const std::string &path) const {
+  std::ofstream ofs(path);
+  if (not ofs) {
+    return false;
+  }
+  write_json(ofs);
+  return static_cast<bool>(ofs);
+}
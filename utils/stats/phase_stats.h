@@ -0,0 +1,75 @@
+#ifndef GENTREE_UTILS_STATS_PHASE_STATS_H_
+#define GENTREE_UTILS_STATS_PHASE_STATS_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct PhaseRecord {
+  std::string name;
+  int depth;
+  double seconds;
+  std::int64_t allocations;
+  std::int64_t allocated_bytes;
+  // largest growth of live heap bytes over the phase
+  std::int64_t peak_heap_bytes;
+  std::int64_t peak_rss_bytes;
+};
+
+/**
+ * Collects per-phase wall time, allocation counts and peak memory of a run.
+ * Phases may nest; they are reported in the order they were opened.
+ * While disabled (the default) opening a phase costs one branch.
+ * Only the thread that enabled collection records phases; worker threads are covered
+ * by the phase that runs them.
+ */
+class PhaseStats {
+  struct Open {
+    size_t record;
+    std::chrono::steady_clock::time_point start;
+    std::int64_t allocations, allocated_bytes, live_bytes;
+    std::int64_t peak_heap_bytes, peak_rss_bytes;
+  };
+  std::string tool_;
+  std::vector<PhaseRecord> records_;
+  std::vector<Open> open_;
+  std::chrono::steady_clock::time_point created_;
+  // the run's RSS high-water mark up to the last time a phase restarted it
+  std::int64_t peak_rss_bytes_ = 0;
+  PhaseStats();
+  void fold_peaks();
+ public:
+  inline static bool enabled_ = false;
+  inline static std::thread::id owner_;
+  static PhaseStats& instance();
+  [[nodiscard]] static bool enabled() { return enabled_ and std::this_thread::get_id() == owner_; }
+  // starts collecting (and counting allocations) on behalf of "tool"
+  void enable(const std::string &tool);
+  void begin(const char *name);
+  void end();
+  [[nodiscard]] const std::vector<PhaseRecord> &records() const;
+  void write_json(std::ostream &os) const;
+  bool write_json(const std::string &path) const;
+};
+
+class ScopedPhase {
+  bool active_;
+ public:
+  explicit ScopedPhase(const char *name) : active_(PhaseStats::enabled()) {
+    if (active_) {
+      PhaseStats::instance().begin(name);
+    }
+  }
+  ~ScopedPhase() {
+    if (active_) {
+      PhaseStats::instance().end();
+    }
+  }
+  ScopedPhase(const ScopedPhase&) = delete;
+  ScopedPhase& operator=(const ScopedPhase&) = delete;
+};
+
+#endif //GENTREE_UTILS_STATS_PHASE_STATS_H_